@@ -6,48 +6,154 @@
 // read from helicopter. Uses 0.7 V range to determine this ADC value as a
 // percentage height of total range
 //
+// The average is a moving window maintained by the ADC interrupts: each new
+// value is added to a running sum and the value it evicts subtracted. The
+// sum is a single 32 bit word (at most 256 x 4095), written only by the
+// interrupts, so reading it is an atomic snapshot of a whole window.
+//
 // Authors: T.R. Peterson, M.G. Gardyne, M. Comber
-// Last modified: 19/05/2021
+// Last modified: 18/10/2026
 //
 // Sourced code acknowledged in function descriptions
 
 #include <stdint.h>
 #include <stdbool.h>
-#include "inc/hw_memmap.h"
-#include "driverlib/adc.h"
-#include "driverlib/sysctl.h"
-#include "driverlib/pwm.h"
 #include "altitude.h"
-#include "circBufT.h"
 #include "pwmGen.h"
 #include "responseControl.h"
+#include "isrProfile.h"
+#include "isrLatency.h"
+#include "handoff.h"
+#include "hal.h"
 
 //*****************************************************************************
 // Global Variables
 //*****************************************************************************
-static circBuf_t g_inBuffer;
+typedef struct {
+    uint16_t values[HEIGHT_WINDOW];     // Most recent values, oldest at index
+    uint16_t index;                     // Next value to replace
+    uint16_t count;                     // Values held, up to HEIGHT_WINDOW
+    uint32_t sum;                       // Sum of the values held
+} height_window_s;
+
+static volatile height_window_s height_window;
+
+// Every value, for the height estimator (kept with HEIGHT_ESTIMATOR, and
+// on the host for comparison)
+static height_totals_s height_totals;
+static seqlock_s height_totals_lock;
+
+#ifdef ADC_DMA
+static uint16_t adc_blocks[2 * ADC_DMA_BLOCK];  // uDMA ping-pong buffer
+#endif
+
+//*****************************************************************************
+// Add a value to the moving average window, evicting the oldest. Called
+// only from the ADC interrupts.
+//*****************************************************************************
+static void
+writeHeightWindow (uint16_t value)
+{
+    uint32_t sum = height_window.sum + value;
+    uint16_t index = height_window.index;
+
+    if (height_window.count < HEIGHT_WINDOW)
+        height_window.count++;
+    else
+        sum -= height_window.values[index];
+
+    height_window.values[index] = value;
+    height_window.index = (index + 1 < HEIGHT_WINDOW) ? index + 1 : 0;
+
+    // Publish the new window with a single store
+    height_window.sum = sum;
+
+#if defined(HEIGHT_ESTIMATOR) || defined(HAL_HOST)
+    // And the running totals, for the estimator
+    height_totals_s totals = { height_totals.sum + value, height_totals.count + 1 };
+
+    seqlockWrite (&height_totals_lock, &height_totals, &totals, sizeof (totals));
+#endif
+}
 
 //*****************************************************************************
 // The handler for the ADC conversion complete interrupt.
-// Writes to the circular buffer.
+// Adds the sample to the running-sum moving average window.
 // Sourced from:  P.J. Bones  UCECE
 //*****************************************************************************
 void
 ADCIntHandler(void)
 {
+    LATENCY_ENTER(HAL_INT_ADC);
     uint32_t ulValue;
+    PROFILE_START();
 
     //
-    // Get the single sample from ADC0.  ADC_BASE is defined in
-    // inc/hw_memmap.h
-    ADCSequenceDataGet(ADC0_BASE, 3, &ulValue);
+    // Get the single sample from ADC0
+    ulValue = halADCGet();
     //
-    // Place it in the circular buffer (advancing write index)
-    writeCircBuf (&g_inBuffer, ulValue);
+    // Add it to the moving average
+    writeHeightWindow (ulValue);
     //
     // Clean up, clearing the interrupt
-    ADCIntClear(ADC0_BASE, 3);
+    halADCIntClear();
+
+    PROFILE_STOP(PROFILE_ADC_INT);
+    LATENCY_EXIT(HAL_INT_ADC);
+}
+
+#ifdef ADC_BURST
+//*****************************************************************************
+// The handler for a completed sequence 0 burst.
+// Adds the rounded mean of the burst to the moving average.
+//*****************************************************************************
+void
+ADCBurstIntHandler(void)
+{
+    LATENCY_ENTER(HAL_INT_ADC);
+    uint32_t samples[HAL_ADC_BURST_LEN];
+    uint32_t count;
+    uint32_t sum = 0;
+    uint32_t i;
+    PROFILE_START();
+
+    count = halADCBurstGet(samples);
+    for (i = 0; i < count; i++)
+        sum += samples[i];
+
+    if (count)
+        writeHeightWindow ((2 * sum + count) / 2 / count);
+
+    halADCIntClear();
+
+    PROFILE_STOP(PROFILE_ADC_INT);
+    LATENCY_EXIT(HAL_INT_ADC);
+}
+#endif
+
+#ifdef ADC_DMA
+//*****************************************************************************
+// The handler for a completed half of the streamed ADC buffer.
+// Adds the block of samples to the moving average.
+//*****************************************************************************
+void
+ADCBlockIntHandler(void)
+{
+    LATENCY_ENTER(HAL_INT_ADC);
+    const uint16_t *block;
+    uint16_t i;
+    PROFILE_START();
+
+    block = halADCStreamComplete();
+    if (block) {
+        for (i = 0; i < ADC_DMA_BLOCK; i++)
+            writeHeightWindow (block[i]);
+    }
+
+    PROFILE_STOP(PROFILE_ADC_INT);
+    LATENCY_EXIT(HAL_INT_ADC);
 }
+#endif
 
 //*****************************************************************************
 // Initialise ADC functions
@@ -56,38 +162,28 @@ ADCIntHandler(void)
 void
 initADC (void)
 {
+#ifdef ADC_DMA
     //
-    // The ADC0 peripheral must be enabled for configuration and use.
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
-
-    // Enable sample sequence 3 with a processor signal trigger.  Sequence 3
-    // will do a single sample when the processor sends a signal to start the
-    // conversion.
-    ADCSequenceConfigure(ADC0_BASE, 3, ADC_TRIGGER_PROCESSOR, 0);
-
+    // Sample the height sensor continuously, interrupting once per block
+    halADCStreamInit(adc_blocks, ADC_DMA_BLOCK, ADC_DMA_RATE_HZ, ADCBlockIntHandler);
+#elif defined(ADC_BURST)
     //
-    // Configure step 0 on sequence 3.  Sample channel 0 (ADC_CTL_CH0) in
-    // single-ended mode (default) and configure the interrupt flag
-    // (ADC_CTL_IE) to be set when the sample is done.  Tell the ADC logic
-    // that this is the last conversion on sequence 3 (ADC_CTL_END).  Sequence
-    // 3 has only one programmable step.  Sequence 1 and 2 have 4 steps, and
-    // sequence 0 has 8 programmable steps.  Since we are only doing a single
-    // conversion using sequence 3 we will only configure step 0.  For more
-    // on the ADC sequences and steps, refer to the LM3S1968 datasheet.
-    ADCSequenceStepConfigure(ADC0_BASE, 3, 0, ADC_CTL_CH9 | ADC_CTL_IE |
-                             ADC_CTL_END); // Channel 9 (PE4)
-
+    // Convert a burst of samples on ADC0 sequence 0 each trigger
+    halADCBurstInit(ADCBurstIntHandler);
+#else
     //
-    // Since sample sequence 3 is now configured, it must be enabled.
-    ADCSequenceEnable(ADC0_BASE, 3);
+    // Sample the height sensor (channel 9, PE4) on ADC0 sequence 3 each time
+    // the processor triggers a conversion, interrupting when it completes
+    halADCInit(ADCIntHandler);
+#endif
 
+#if defined(ADC_TIMER) && !defined(ADC_DMA)
     //
-    // Register the interrupt handler
-    ADCIntRegister (ADC0_BASE, 3, ADCIntHandler);
+    // Convert at exact intervals from a hardware timer
+    halADCTimerTrigger(ADC_TIMER_RATE_HZ);
+#endif
 
-    //
-    // Enable interrupts for ADC0 sequence 3 (clears any outstanding interrupts)
-    ADCIntEnable(ADC0_BASE, 3);
+    halADCOversample(ADC_OVERSAMPLE);
 }
 
 //*****************************************************************************
@@ -96,16 +192,11 @@ initADC (void)
 void
 initAltitude(void)
 {
-    // As a precaution, make sure that the peripherals used are reset
-    SysCtlPeripheralReset (PWM_MAIN_PERIPH_GPIO); // Used for PWM output
-    SysCtlPeripheralReset (PWM_MAIN_PERIPH_PWM);  // Main Rotor PWM
-
-    initCircBuf (&g_inBuffer, BUF_SIZE);
     initADC ();
     initialisePWMMain ();
 
     // Initialisation is complete, so turn on the output.
-    PWMOutputState(PWM_MAIN_BASE, PWM_MAIN_OUTBIT, true);
+    halPWMMainEnable(true);
 }
 
 //*****************************************************************************
@@ -130,18 +221,39 @@ calculate_percent_height(uint16_t current_height, uint16_t landed_height)
 int
 getHeight(void)
 {
-    int32_t sum;
+    uint32_t sum;
+    uint32_t count;
     int32_t mean;
-    uint16_t i;
+    PROFILE_START();
     //
-    // Background task: calculate the (approximate) mean of the values in the
-    // circular buffer and display it, together with the sample number.
-    sum = 0;
-    for (i = 0; i < BUF_SIZE; i++)
-        sum = sum + (readCircBuf (&g_inBuffer));
+    // Snapshot the window. The count only changes while the window first
+    // fills, so it is re-read until it matches the sum.
+    do {
+        count = height_window.count;
+        sum = height_window.sum;
+    } while (count != height_window.count);
+
+    if (count == 0) {
+        PROFILE_STOP(PROFILE_GET_HEIGHT);
+        return 0;
+    }
 
-    // Calculate the rounded mean of the buffer contents
-    mean = (2 * sum + BUF_SIZE) / 2 / BUF_SIZE;
+    // Calculate the rounded mean of the window
+    mean = (2 * sum + count) / 2 / count;
 
+    PROFILE_STOP(PROFILE_GET_HEIGHT);
     return mean;
 }
+
+//*****************************************************************************
+// Running totals of every ADC value
+//*****************************************************************************
+height_totals_s
+getHeightTotals (void)
+{
+    height_totals_s totals;
+
+    seqlockRead (&height_totals_lock, &totals, &height_totals, sizeof (totals));
+
+    return totals;
+}
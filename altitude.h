@@ -6,8 +6,28 @@
 //
 // Support for altitude functionality of the helicopter
 //
+// By default the ADC is triggered once per SysTick and interrupts for every
+// sample. Defining ADC_DMA instead samples continuously at ADC_DMA_RATE_HZ
+// into a uDMA ping-pong buffer, interrupting once per ADC_DMA_BLOCK samples.
+// Defining ADC_BURST converts a burst of eight samples on sequence 0 per
+// trigger and buffers their mean. ADC_OVERSAMPLE sets hardware averaging of
+// each conversion in any mode.
+//
+// Defining ADC_TIMER triggers the single sample or burst conversions from a
+// hardware timer at ADC_TIMER_RATE_HZ rather than from the SysTick handler,
+// giving exact sample spacing. ADC_DMA is always timer triggered.
+//
+// Buffered values are averaged over a window of HEIGHT_WINDOW values by a
+// running sum kept up to date in the interrupt, so getHeight costs the same
+// for any window size up to 256.
+//
+// Defining HEIGHT_ESTIMATOR keeps running totals of every value as well,
+// for the height estimator (heightEstimator.h), and has it give the height
+// used by the controllers instead of the window. Host builds keep the
+// totals and run the estimator regardless, so the two can be compared.
+//
 // Authors: T.R. Peterson, M.G. Gardyne, M. Comber
-// Last modified:  19/5/2021
+// Last modified:  18/10/2026
 //
 // *******************************************************
 
@@ -17,8 +37,32 @@
 //*****************************************************************************
 // Constants
 //*****************************************************************************
-#define BUF_SIZE            10   // Buffer size for sample averaging
+#ifndef HEIGHT_WINDOW
+#define HEIGHT_WINDOW       10   // Values in the moving average, 1 to 256
+#endif
 #define ADC_BITS            4095 // 12 bit ADC
+#define ADC_DMA_RATE_HZ     8000 // Streamed sample rate (ADC_DMA)
+#define ADC_DMA_BLOCK       64   // Samples per streamed interrupt (ADC_DMA)
+#ifndef ADC_TIMER_RATE_HZ
+#define ADC_TIMER_RATE_HZ   2000 // Timer triggered sample rate (ADC_TIMER)
+#endif
+
+#ifndef ADC_OVERSAMPLE
+#define ADC_OVERSAMPLE      1    // Hardware averaging per conversion: 1, 2, 4 ... 64
+#endif
+
+#if HEIGHT_WINDOW < 1 || HEIGHT_WINDOW > 256
+#error "HEIGHT_WINDOW must be from 1 to 256"
+#endif
+
+#if defined(ADC_BURST) && defined(ADC_DMA)
+#error "ADC_BURST and ADC_DMA are alternative acquisition modes"
+#endif
+
+// Conversions are started by the SysTick handler unless a timer starts them
+#if !defined(ADC_DMA) && !defined(ADC_TIMER)
+#define ADC_SYSTICK_TRIGGER
+#endif
 
 //*****************************************************************************
 // Structure definitions
@@ -28,6 +72,13 @@ typedef struct {
     int16_t target;
 } height_data_s;
 
+// Sum and count of every ADC value since power up. Both wrap, so take
+// the difference between two readings.
+typedef struct {
+    uint32_t sum;
+    uint32_t count;
+} height_totals_s;
+
 //*****************************************************************************
 // Initialise altitude module
 //*****************************************************************************
@@ -46,4 +97,10 @@ calculate_percent_height(uint16_t current_height_in, uint16_t landed_height_in);
 int
 getHeight(void);
 
+//*****************************************************************************
+// Running totals of every ADC value
+//*****************************************************************************
+height_totals_s
+getHeightTotals (void);
+
 #endif /* ALTITUDE_H_ */
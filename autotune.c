@@ -0,0 +1,295 @@
+//*****************************************************************************
+//
+// autotune.c
+//
+// Relay feedback PI tuning: a relay experiment on each rotor in turn,
+// measuring the limit cycle it settles into, then PI gains from the
+// ultimate gain and period found.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "autotune.h"
+#include "hal.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define AUTOTUNE_PI     3.14159265f
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+// Relay experiment on one axis
+typedef struct {
+    int32_t step;               // Relay step either side of the bias (%)
+    int32_t hysteresis;         // Error band the relay holds through
+    int32_t limit;              // Error that ends the experiment
+    int32_t bias;               // Mean PI duty while settling (%)
+    int32_t output;             // Current relay output, +step or -step
+    uint32_t cycle_steps;       // Steps since the last rising switch
+    int32_t error_max;          // Error extremes over the current cycle
+    int32_t error_min;
+    uint32_t cycles;            // Rising switches seen
+    float period_sum;           // Over the cycles measured (s)
+    float amplitude_sum;
+    autotune_result_s result;
+} relay_s;
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+static autotune_phase phase = AUTOTUNE_FAILED;
+static autotune_phase axis;             // Axis settling for, or under test
+static uint32_t period_ms;              // Time between autotuneUpdate calls
+static uint32_t steps;                  // Steps in the current phase
+static int32_t duty_sum_main;           // PI duties summed while settling
+static int32_t duty_sum_tail;
+static uint32_t duty_samples;
+static relay_s relay_main = {
+    .step = AUTOTUNE_RELAY_MAIN,
+    .hysteresis = AUTOTUNE_HYSTERESIS_MAIN,
+    .limit = AUTOTUNE_LIMIT_MAIN,
+};
+static relay_s relay_tail = {
+    .step = AUTOTUNE_RELAY_TAIL,
+    .hysteresis = AUTOTUNE_HYSTERESIS_TAIL,
+    .limit = AUTOTUNE_LIMIT_TAIL,
+};
+
+//*****************************************************************************
+// Start the experiments
+//*****************************************************************************
+void
+autotuneStart (uint32_t period)
+{
+    period_ms = period;
+    axis = AUTOTUNE_MAIN;
+    phase = AUTOTUNE_SETTLING;
+    steps = 0;
+    duty_sum_main = 0;
+    duty_sum_tail = 0;
+    duty_samples = 0;
+}
+
+//*****************************************************************************
+// Begin the relay on an axis, about the PI duty that held it while settling
+//*****************************************************************************
+static void
+relayBegin (relay_s *relay, int32_t bias, int32_t error)
+{
+    relay->bias = bias;
+    relay->output = error >= 0 ? relay->step : -relay->step;
+    relay->cycle_steps = 0;
+    relay->error_max = error;
+    relay->error_min = error;
+    relay->cycles = 0;
+    relay->period_sum = 0;
+    relay->amplitude_sum = 0;
+    relay->result.cycles = 0;
+}
+
+//*****************************************************************************
+// One relay step: returns the duty, and sets the result once enough
+// cycles have been measured
+//*****************************************************************************
+static int32_t
+relayStep (relay_s *relay, int32_t error)
+{
+    float amplitude;
+
+    relay->cycle_steps++;
+    if (error > relay->error_max)
+        relay->error_max = error;
+    if (error < relay->error_min)
+        relay->error_min = error;
+
+    if (error < -relay->hysteresis && relay->output > 0) {
+        relay->output = -relay->step;
+    } else if (error > relay->hysteresis && relay->output < 0) {
+        // A rising switch ends one cycle and starts the next
+        relay->output = relay->step;
+        relay->cycles++;
+        if (relay->cycles > AUTOTUNE_SKIP_CYCLES) {
+            relay->period_sum += (float) relay->cycle_steps * period_ms / 1000;
+            relay->amplitude_sum += (float) (relay->error_max - relay->error_min) / 2;
+            relay->result.cycles++;
+        }
+        relay->cycle_steps = 0;
+        relay->error_max = error;
+        relay->error_min = error;
+
+        if (relay->result.cycles == AUTOTUNE_CYCLES) {
+            amplitude = relay->amplitude_sum / AUTOTUNE_CYCLES;
+            relay->result.ultimate_period = relay->period_sum / AUTOTUNE_CYCLES;
+            relay->result.ultimate_gain = amplitude > relay->hysteresis
+                ? 4 * relay->step / (AUTOTUNE_PI * sqrtf (amplitude * amplitude
+                                                  - relay->hysteresis * relay->hysteresis))
+                : 0;
+        }
+    }
+
+    return relay->bias + relay->output;
+}
+
+//*****************************************************************************
+// True if a finished relay found a usable limit cycle
+//*****************************************************************************
+static bool
+relayValid (const relay_s *relay)
+{
+    return relay->result.ultimate_gain > 0 &&
+           relay->result.ultimate_period * 1000 >= AUTOTUNE_MIN_PERIOD_MS &&
+           relay->result.ultimate_period * 1000 <= AUTOTUNE_MAX_PERIOD_MS;
+}
+
+//*****************************************************************************
+// Limit a relay duty to the rotor's range
+//*****************************************************************************
+static uint32_t
+clampDuty (int32_t duty, int32_t min, int32_t max)
+{
+    if (duty > max)
+        return max;
+    if (duty < min)
+        return min;
+    return duty;
+}
+
+//*****************************************************************************
+// Run one step
+//*****************************************************************************
+autotune_phase
+autotuneUpdate (int32_t height_error, int32_t yaw_error, duty_cycle_s *duty)
+{
+    relay_s *relay = axis == AUTOTUNE_MAIN ? &relay_main : &relay_tail;
+    int32_t error = axis == AUTOTUNE_MAIN ? height_error : yaw_error;
+
+    steps++;
+
+    switch (phase)
+    {
+    case AUTOTUNE_SETTLING:
+        // Average the PI duties over the second half, once settled
+        if (steps > AUTOTUNE_SETTLE_MS / period_ms / 2) {
+            duty_sum_main += duty->main;
+            duty_sum_tail += duty->tail;
+            duty_samples++;
+        }
+        if (steps >= AUTOTUNE_SETTLE_MS / period_ms) {
+            relayBegin (relay, (axis == AUTOTUNE_MAIN ? duty_sum_main : duty_sum_tail)
+                        / (int32_t) duty_samples, error);
+            phase = axis;
+            steps = 0;
+        }
+        break;
+    case AUTOTUNE_MAIN:
+    case AUTOTUNE_TAIL:
+        if (error > relay->limit || error < -relay->limit ||
+            steps >= AUTOTUNE_TIMEOUT_MS / period_ms) {
+            phase = AUTOTUNE_FAILED;
+            break;
+        }
+
+        if (axis == AUTOTUNE_MAIN)
+            duty->main = clampDuty (relayStep (relay, error), MIN_DUTY_MAIN, MAX_DUTY_MAIN);
+        else
+            duty->tail = clampDuty (relayStep (relay, error), MIN_DUTY_TAIL, MAX_DUTY_TAIL);
+
+        if (relay->result.cycles < AUTOTUNE_CYCLES)
+            break;
+
+        if (!relayValid (relay)) {
+            phase = AUTOTUNE_FAILED;
+        } else if (axis == AUTOTUNE_MAIN) {
+            // Let the main rotor settle under PI again, then the tail
+            axis = AUTOTUNE_TAIL;
+            phase = AUTOTUNE_SETTLING;
+            steps = 0;
+            duty_sum_main = 0;
+            duty_sum_tail = 0;
+            duty_samples = 0;
+        } else {
+            phase = AUTOTUNE_DONE;
+        }
+        break;
+    case AUTOTUNE_DONE:
+    case AUTOTUNE_FAILED:
+        break;
+    }
+
+    return phase;
+}
+
+//*****************************************************************************
+// Abandon the experiments
+//*****************************************************************************
+void
+autotuneAbort (void)
+{
+    if (phase < AUTOTUNE_DONE)
+        phase = AUTOTUNE_FAILED;
+}
+
+//*****************************************************************************
+// Pass the current phase out of module
+//*****************************************************************************
+autotune_phase
+autotunePhase (void)
+{
+    return phase;
+}
+
+//*****************************************************************************
+// PI gains from one axis' result
+//*****************************************************************************
+static void
+relayGains (const relay_s *relay, float *proportional, float *integral)
+{
+    *proportional = AUTOTUNE_KP_FACTOR * relay->result.ultimate_gain;
+    *integral = *proportional / (AUTOTUNE_TI_FACTOR * relay->result.ultimate_period * TIMER_RATE);
+}
+
+//*****************************************************************************
+// PI gains from the experiments
+//*****************************************************************************
+void
+autotuneGains (pi_gains_s *gains)
+{
+    relayGains (&relay_main, &gains->proportional_main, &gains->integral_main);
+    relayGains (&relay_tail, &gains->proportional_tail, &gains->integral_tail);
+}
+
+//*****************************************************************************
+// Send the results as CSV lines
+//*****************************************************************************
+static void
+autotuneLine (void (*send)(char *line), char *name, const relay_s *relay)
+{
+    char line[96];
+    float proportional;
+    float integral;
+
+    relayGains (relay, &proportional, &integral);
+    usprintf (line, "%s,%d,%u,%u,%u,%u\r\n", name, relay->step,
+              (uint32_t) (relay->result.ultimate_gain * 1000),
+              (uint32_t) (relay->result.ultimate_period * 1000),
+              (uint32_t) (proportional * 1000), (uint32_t) (integral * TIMER_RATE * 1000));
+    send (line);
+}
+
+void
+autotuneReport (void (*send)(char *line))
+{
+    send ("axis,relay,ultimate_gain_x1000,ultimate_period_ms,proportional_x1000,integral_per_s_x1000\r\n");
+    if (phase != AUTOTUNE_DONE) {
+        send ("autotune,failed\r\n");
+        return;
+    }
+    autotuneLine (send, "main", &relay_main);
+    autotuneLine (send, "tail", &relay_tail);
+}
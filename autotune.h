@@ -0,0 +1,117 @@
+#ifndef AUTOTUNE_H_
+#define AUTOTUNE_H_
+
+// *******************************************************
+// autotune.h
+//
+// PI gain tuning by relay feedback. While in the autotuning flight mode
+// each rotor in turn is switched between two duties either side of the
+// duty holding the current setpoint, by the sign of its error, with the
+// other rotor left under PI control. This drives the axis into a limit
+// cycle whose amplitude and period give the ultimate gain and period:
+//
+//   Ku = 4 d / (pi sqrt (a^2 - h^2)),   Tu = cycle period
+//
+// for a relay step d, error amplitude a and relay hysteresis h. The PI
+// gains follow from these by the Tyreus-Luyben rule (AUTOTUNE_*_FACTOR),
+// which is better damped than Ziegler-Nichols: on heliSim the
+// Ziegler-Nichols tail gains overshot the large yaw steps.
+//
+// The experiment gives up, leaving the gains alone, if the error leaves
+// AUTOTUNE_*_LIMIT or no steady limit cycle is found within
+// AUTOTUNE_TIMEOUT_MS. No hardware dependencies; it is run from
+// updateResponseControl at the main loop's control rate.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "responseControl.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define AUTOTUNE_RELAY_MAIN     6       // Main relay step either side of the hover duty (%)
+#define AUTOTUNE_RELAY_TAIL     10      // Tail relay step (%)
+#define AUTOTUNE_HYSTERESIS_MAIN 1      // Height error band the relay holds through (%)
+#define AUTOTUNE_HYSTERESIS_TAIL 2      // Yaw error band (deg)
+#define AUTOTUNE_LIMIT_MAIN     25      // Height error that ends the experiment (%)
+#define AUTOTUNE_LIMIT_TAIL     60      // Yaw error that ends the experiment (deg)
+#define AUTOTUNE_SETTLE_MS      3000    // Both axes under PI before each experiment
+#define AUTOTUNE_TIMEOUT_MS     30000   // Longest experiment on one axis
+#define AUTOTUNE_SKIP_CYCLES    2       // Cycles left to settle into the limit cycle
+#define AUTOTUNE_CYCLES         4       // Cycles averaged
+#define AUTOTUNE_MIN_PERIOD_MS  200     // Ultimate periods accepted
+#define AUTOTUNE_MAX_PERIOD_MS  10000
+
+// Tyreus-Luyben PI: Kp = Ku / 3.2, Ti = 2.2 Tu (Ziegler-Nichols is 0.45, 0.83)
+#define AUTOTUNE_KP_FACTOR      0.3125f
+#define AUTOTUNE_TI_FACTOR      2.2f
+
+#define AUTOTUNE_CMD_START      'a'     // UART command to tune the gains
+#define AUTOTUNE_CMD_STORE      'A'     // Tune, and store the gains with the calibration
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef enum {
+    AUTOTUNE_SETTLING,          // Both axes under PI before an experiment
+    AUTOTUNE_MAIN,              // Relay on the main rotor
+    AUTOTUNE_TAIL,              // Relay on the tail rotor
+    AUTOTUNE_DONE,              // Tuned gains ready from autotuneGains
+    AUTOTUNE_FAILED,            // Gave up; the gains are unchanged
+} autotune_phase;
+
+// Result of the experiment on one axis
+typedef struct {
+    float ultimate_gain;        // Duty (%) per unit error
+    float ultimate_period;      // Seconds
+    uint32_t cycles;            // Cycles measured
+} autotune_result_s;
+
+//*****************************************************************************
+// Start the experiments, with autotuneUpdate called every period ms
+//*****************************************************************************
+void
+autotuneStart (uint32_t period);
+
+//*****************************************************************************
+// Run one step. duty holds the duties last applied; the duty of the rotor
+// under test is replaced by the relay output. Returns the phase the step
+// leaves the experiment in.
+//*****************************************************************************
+autotune_phase
+autotuneUpdate (int32_t height_error, int32_t yaw_error, duty_cycle_s *duty);
+
+//*****************************************************************************
+// Abandon the experiments, leaving the gains alone, as when switched down
+// during them
+//*****************************************************************************
+void
+autotuneAbort (void);
+
+//*****************************************************************************
+// Pass the current phase out of module
+//*****************************************************************************
+autotune_phase
+autotunePhase (void);
+
+//*****************************************************************************
+// PI gains from the experiments, once done. integral gains are per control
+// step, as in pi_gains_s.
+//*****************************************************************************
+void
+autotuneGains (pi_gains_s *gains);
+
+//*****************************************************************************
+// Send the results as CSV lines: axis, relay step, ultimate gain x1000,
+// ultimate period (ms), proportional gain x1000, integral gain per second
+// x1000
+//*****************************************************************************
+void
+autotuneReport (void (*send)(char *line));
+
+#endif /* AUTOTUNE_H_ */
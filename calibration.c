@@ -0,0 +1,125 @@
+//*****************************************************************************
+//
+// calibration.c
+//
+// Calibration store in two alternating EEPROM slots. Each slot is
+// CAL_SLOT_WORDS words: magic, version and sequence, the calibration
+// values, and a CRC-16/CCITT (telemetryCRC) of the words before it.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "calibration.h"
+#include "telemetry.h"
+#include "hal.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define CAL_MAGIC       0x4C414348      // "HCAL"
+#define CAL_SLOTS       2
+#define CAL_SLOT_WORDS  20
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t sequence;          // Incremented on each write
+    calibration_s cal;
+    uint32_t crc;
+} cal_slot_s;
+
+_Static_assert (sizeof (cal_slot_s) == CAL_SLOT_WORDS * 4, "calibration slot has padding");
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+static bool eeprom_ok;
+static calibration_s stored;                // Contents of the newest slot
+static bool stored_valid;
+static uint16_t stored_sequence;
+static uint32_t stored_slot;
+
+//*****************************************************************************
+// Check a slot read from the EEPROM
+//*****************************************************************************
+static bool
+calSlotValid (const cal_slot_s *slot)
+{
+    return slot->magic == CAL_MAGIC && slot->version == CAL_VERSION &&
+           slot->crc == telemetryCRC ((const uint8_t *) slot, offsetof (cal_slot_s, crc));
+}
+
+//*****************************************************************************
+// Read the newest valid calibration
+//*****************************************************************************
+bool
+calibrationLoad (calibration_s *cal)
+{
+    cal_slot_s slot;
+    uint32_t i;
+
+    eeprom_ok = halEEPROMInit ();
+    stored_valid = false;
+    stored_slot = CAL_SLOTS - 1;
+
+    for (i = 0; eeprom_ok && i < CAL_SLOTS; i++)
+    {
+        if (!halEEPROMRead (CAL_ADDRESS + i * sizeof (slot), (uint32_t *) &slot, CAL_SLOT_WORDS) ||
+            !calSlotValid (&slot))
+            continue;
+
+        // Newer by sequence, allowing for wrap around
+        if (!stored_valid || (int16_t) (slot.sequence - stored_sequence) > 0) {
+            stored = slot.cal;
+            stored_valid = true;
+            stored_sequence = slot.sequence;
+            stored_slot = i;
+        }
+    }
+
+    if (stored_valid)
+        *cal = stored;
+
+#ifdef CAL_COLD_START
+    return false;
+#else
+    return stored_valid;
+#endif
+}
+
+//*****************************************************************************
+// Store calibration in the slot not holding the newest
+//*****************************************************************************
+void
+calibrationSave (const calibration_s *cal)
+{
+    cal_slot_s slot;
+    uint32_t next = (stored_slot + 1) % CAL_SLOTS;
+
+    if (!eeprom_ok || (stored_valid && memcmp (cal, &stored, sizeof (stored)) == 0))
+        return;
+
+    memset (&slot, 0, sizeof (slot));
+    slot.magic = CAL_MAGIC;
+    slot.version = CAL_VERSION;
+    slot.sequence = stored_valid ? stored_sequence + 1 : 0;
+    slot.cal = *cal;
+    slot.crc = telemetryCRC ((const uint8_t *) &slot, offsetof (cal_slot_s, crc));
+
+    if (!halEEPROMWrite (CAL_ADDRESS + next * sizeof (slot), (uint32_t *) &slot,
+                         CAL_SLOT_WORDS))
+        return;
+
+    stored = *cal;
+    stored_slot = next;
+    stored_valid = true;
+    stored_sequence = slot.sequence;
+}
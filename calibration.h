@@ -0,0 +1,71 @@
+#ifndef CALIBRATION_H_
+#define CALIBRATION_H_
+
+// *******************************************************
+// calibration.h
+//
+// Calibration kept in the on-chip EEPROM between power cycles: the hover
+// duty, the height ADC reading when landed and the disc count the
+// helicopter came to rest at after landing, relative to the reference.
+// Stored values are only a starting point for initialising, which still
+// verifies them (responseControlWarmStart, yawWarmStart). PI gains from
+// autotune are kept too, once asked for with AUTOTUNE_CMD_STORE, and the
+// coupling map (coupling.h) as calibrated in flight.
+//
+// Two slots are written alternately, each with a version, a sequence
+// number and a CRC, so a write cut short by a reset leaves the previous
+// calibration readable. A slot is used only if its magic, version and CRC
+// are right; a version change discards old calibration.
+//
+// Defining CAL_COLD_START ignores the stored values, so the helicopter
+// searches for everything as before, but still stores what it finds.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "responseControl.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define CAL_VERSION                 3
+#define CAL_ADDRESS                 0       // EEPROM byte address of the first slot
+#define CAL_YAW_UNKNOWN             INT32_MIN
+#define CAL_LANDED_ADC_TOLERANCE    25      // Landed reading change still trusted (ADC counts)
+#define CAL_REST_MS                 1000    // Yaw unchanged for this long after landing is at rest
+
+// Calibration flags
+#define CAL_FLAG_GAINS              0x01    // gains holds tuned PI gains
+#define CAL_FLAG_COUPLING           0x02    // coupling holds a coupling map
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef struct {
+    uint32_t hover_duty;        // Main duty holding a hover (%)
+    int32_t landed_adc;         // Height ADC reading when landed
+    int32_t yaw_rest;           // Disc count from the reference at rest after
+                                // landing, or CAL_YAW_UNKNOWN
+    uint32_t flags;             // CAL_FLAG_*
+    pi_gains_s gains;           // PI gains, if CAL_FLAG_GAINS
+    coupling_map_s coupling;    // Coupling map, if CAL_FLAG_COUPLING
+} calibration_s;
+
+//*****************************************************************************
+// Read the newest valid calibration, returning false if there is none
+//*****************************************************************************
+bool
+calibrationLoad (calibration_s *cal);
+
+//*****************************************************************************
+// Store calibration, if it differs from what was loaded or last stored.
+// Blocks while the EEPROM is programmed.
+//*****************************************************************************
+void
+calibrationSave (const calibration_s *cal);
+
+#endif /* CALIBRATION_H_ */
@@ -0,0 +1,153 @@
+//*****************************************************************************
+//
+// coupling.c
+//
+// Tail rotor feed-forward from the main rotor duty, through a map
+// calibrated in flight. All Q8.24 fixed point, as the feed-forward runs in
+// the control interrupt for both PI implementations.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "coupling.h"
+#include "responseControl.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define COUPLING_LAG_STEPS      (COUPLING_LAG_MS * TIMER_RATE / 1000)
+#define COUPLING_LEAD_STEPS     (COUPLING_LEAD_MS * TIMER_RATE / 1000)
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+// Main rotor model, as the main duty that would hold its speed (%)
+static q24_t main_speed;
+
+// Control updates holding the setpoints, and their duties summed
+static uint32_t steady_updates;
+static uint32_t sum_main;
+static uint32_t sum_tail;
+
+//*****************************************************************************
+// Fill in the uncalibrated map
+//*****************************************************************************
+void
+couplingMapDefault (coupling_map_s *map)
+{
+    int32_t i;
+
+    for (i = 0; i < COUPLING_MAP_LEN; i++)
+        map->tail[i] = Q24_FROM_FLOAT (COUPLING_SLOPE * (COUPLING_MAP_FIRST + i * COUPLING_MAP_STEP));
+}
+
+//*****************************************************************************
+// Points either side of a main duty, and the fraction of the way from the
+// first to the second, clamped to the ends of the map
+//*****************************************************************************
+static void
+mapPosition (q24_t duty_main, int32_t *i, q24_t *fraction)
+{
+    q24_t position = duty_main - q24FromInt (COUPLING_MAP_FIRST);
+
+    if (position <= 0) {
+        *i = 0;
+        *fraction = 0;
+        return;
+    }
+
+    *i = position / q24FromInt (COUPLING_MAP_STEP);
+    if (*i >= COUPLING_MAP_LEN - 1) {
+        *i = COUPLING_MAP_LEN - 2;
+        *fraction = q24FromInt (1);
+        return;
+    }
+
+    *fraction = (position - *i * q24FromInt (COUPLING_MAP_STEP)) / COUPLING_MAP_STEP;
+}
+
+//*****************************************************************************
+// Tail duty from the map for a main duty
+//*****************************************************************************
+q24_t
+couplingMapLookup (const coupling_map_s *map, q24_t duty_main)
+{
+    int32_t i;
+    q24_t fraction;
+
+    mapPosition (duty_main, &i, &fraction);
+
+    return q24Add (map->tail[i], q24Mul (map->tail[i + 1] - map->tail[i], fraction));
+}
+
+//*****************************************************************************
+// Tail feed-forward for this control step
+//*****************************************************************************
+q24_t
+couplingFeedForward (const coupling_map_s *map, uint32_t duty_main)
+{
+    q24_t last_speed = main_speed;
+    q24_t feed;
+    q24_t lead;
+
+    // Main rotor speed lags its duty
+    main_speed += (q24FromInt (duty_main) - main_speed) / COUPLING_LAG_STEPS;
+
+    // Tail duty balancing it, led by its rate of change through the same
+    // map, so a map learnt between steps does not kick the lead
+    feed = couplingMapLookup (map, main_speed);
+    lead = q24MulInt (feed - couplingMapLookup (map, last_speed), COUPLING_LEAD_STEPS);
+
+    return q24Add (feed, lead);
+}
+
+//*****************************************************************************
+// Learn from one control update while flying
+//*****************************************************************************
+bool
+couplingLearn (coupling_map_s *map, int32_t height_error, int32_t yaw_error,
+               uint32_t duty_main, uint32_t duty_tail, q24_t *change)
+{
+    q24_t mean_main;
+    q24_t mean_tail;
+    q24_t before;
+    q24_t error;
+    q24_t fraction;
+    int32_t i;
+
+    // Start again whenever a setpoint is not being held
+    if (abs (height_error) > COUPLING_STEADY_HEIGHT || abs (yaw_error) > COUPLING_STEADY_YAW) {
+        steady_updates = 0;
+        sum_main = 0;
+        sum_tail = 0;
+        return false;
+    }
+
+    sum_main += duty_main;
+    sum_tail += duty_tail;
+    if (++steady_updates < COUPLING_STEADY_UPDATES)
+        return false;
+
+    // Mean duties, adding back the half percent the tail loses on average
+    // to truncating its duty
+    mean_main = ((int64_t) sum_main << Q24_SHIFT) / steady_updates;
+    mean_tail = ((int64_t) sum_tail << Q24_SHIFT) / steady_updates + Q24_FROM_FLOAT (0.5f);
+    steady_updates = 0;
+    sum_main = 0;
+    sum_tail = 0;
+
+    // Move the points either side towards the mean, each by its share
+    before = couplingMapLookup (map, mean_main);
+    error = q24Mul (Q24_FROM_FLOAT (COUPLING_LEARN_RATE), mean_tail - before);
+    mapPosition (mean_main, &i, &fraction);
+    map->tail[i] = q24Add (map->tail[i], q24Mul (error, q24FromInt (1) - fraction));
+    map->tail[i + 1] = q24Add (map->tail[i + 1], q24Mul (error, fraction));
+
+    *change = couplingMapLookup (map, mean_main) - before;
+
+    return *change != 0;
+}
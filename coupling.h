@@ -0,0 +1,84 @@
+#ifndef COUPLING_H_
+#define COUPLING_H_
+
+// *******************************************************
+// coupling.h
+//
+// Feed-forward for the tail rotor against the main rotor's torque. The
+// main rotor's speed is modelled as a first order lag on its duty, and a
+// map from main duty to the tail duty balancing it at that speed gives
+// the feed-forward. A lead proportional to the feed-forward's rate of
+// change makes up for the tail rotor's own lag, so the tail follows a
+// height step instead of waiting for the yaw error to build up.
+//
+// The map starts as a line through the origin (COUPLING_SLOPE) and is
+// calibrated in flight: after COUPLING_STEADY_UPDATES control updates
+// holding both setpoints, the mean tail duty is what the map should give
+// at the mean main duty, and the two points either side move towards it.
+// The map is kept with the rest of the calibration (calibration.h).
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fixedPoint.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define COUPLING_MAP_LEN        9       // Map points
+#define COUPLING_MAP_FIRST      20      // Main duty at the first point (%)
+#define COUPLING_MAP_STEP       10      // Main duty between points (%)
+#define COUPLING_SLOPE          0.65f   // Uncalibrated map: tail duty per main duty
+
+#define COUPLING_LAG_MS         250     // Main rotor speed lag behind its duty
+#define COUPLING_LEAD_MS        100     // Tail rotor speed lag behind its duty
+
+#define COUPLING_STEADY_UPDATES 50      // Control updates holding the setpoints to learn
+#define COUPLING_STEADY_HEIGHT  2       // Height error counted as holding (%)
+#define COUPLING_STEADY_YAW     4       // Yaw error counted as holding (deg)
+#define COUPLING_LEARN_RATE     0.5f    // Fraction of the map error learnt each time
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+// Tail duty (%) balancing the main rotor at each point's main duty
+typedef struct {
+    q24_t tail[COUPLING_MAP_LEN];
+} coupling_map_s;
+
+//*****************************************************************************
+// Fill in the uncalibrated map
+//*****************************************************************************
+void
+couplingMapDefault (coupling_map_s *map);
+
+//*****************************************************************************
+// Tail duty from the map for a main duty, interpolated linearly between
+// points and held beyond the end points
+//*****************************************************************************
+q24_t
+couplingMapLookup (const coupling_map_s *map, q24_t duty_main);
+
+//*****************************************************************************
+// Tail feed-forward for this control step from the main duty just set.
+// Called from the control interrupt every step, as it runs the main rotor
+// model, whether or not the tail is under PI control.
+//*****************************************************************************
+q24_t
+couplingFeedForward (const coupling_map_s *map, uint32_t duty_main);
+
+//*****************************************************************************
+// Learn from one control update while flying: the errors (target less
+// current) and the duties last applied. Returns true if the map changed,
+// with the change in its output at the current main duty in change, which
+// the caller moves out of the tail integral so the duty does not jump.
+//*****************************************************************************
+bool
+couplingLearn (coupling_map_s *map, int32_t height_error, int32_t yaw_error,
+               uint32_t duty_main, uint32_t duty_tail, q24_t *change);
+
+#endif /* COUPLING_H_ */
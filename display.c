@@ -6,16 +6,31 @@
 // OLED display. Displays current height and yaw, as well
 // as main and tail duty cycles.
 //
+// The text on the panel is cached, and only runs of characters that have
+// changed are sent. The main loop calls displayData at DISPLAY_MAX_RATE_HZ.
+//
 // Authors: T.R. Peterson, M.G. Gardyne, M. Comber
 // Last modified: 19/05/2021
 //
 // Sourced code acknowledged in function descriptions
 
 #include <stdint.h>
-#include "utils/ustdlib.h"
-#include "OrbitOLED/OrbitOLEDInterface.h"
+#include <string.h>
 #include "display.h"
 #include "responseControl.h"
+#include "hal.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define DISPLAY_ROWS        4
+#define DISPLAY_COLS        16
+#define DISPLAY_MERGE_GAP   2   // Unchanged characters worth resending to join runs
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+static char shown[DISPLAY_ROWS][DISPLAY_COLS + 1];  // Text currently on the panel
 
 //*****************************************************************************
 // Initialise Display Function
@@ -25,7 +40,54 @@ void
 initDisplay (void)
 {
     // Intialise the Orbit OLED display
-    OLEDInitialise ();
+    halDisplayInit ();
+
+    // The panel starts blank
+    memset (shown, ' ', sizeof (shown));
+    for (int row = 0; row < DISPLAY_ROWS; row++)
+        shown[row][DISPLAY_COLS] = '\0';
+}
+
+//*****************************************************************************
+// Send the runs of characters in a line that differ from the panel
+//*****************************************************************************
+static void
+displayLine (char *line, uint32_t row)
+{
+    char *cache = shown[row];
+    uint32_t col = 0;
+    uint32_t start;
+    uint32_t end;
+    uint32_t length = strlen (line);
+    char saved;
+
+    // Pad to the full width so stale characters are cleared
+    memset (line + length, ' ', DISPLAY_COLS - length);
+    line[DISPLAY_COLS] = '\0';
+
+    while (col < DISPLAY_COLS)
+    {
+        // Find the next changed character
+        while (col < DISPLAY_COLS && line[col] == cache[col])
+            col++;
+        if (col == DISPLAY_COLS)
+            break;
+
+        // Extend the run over changes separated by short unchanged gaps
+        start = col;
+        end = col + 1;
+        for (col = end; col < DISPLAY_COLS && col <= end + DISPLAY_MERGE_GAP; col++)
+            if (line[col] != cache[col])
+                end = col + 1;
+        col = end;
+
+        // Draw the run and update the cache
+        memcpy (cache + start, line + start, end - start);
+        saved = line[end];
+        line[end] = '\0';
+        halDisplayString (line + start, start, row);
+        line[end] = saved;
+    }
 }
 
 //*****************************************************************************
@@ -34,16 +96,16 @@ initDisplay (void)
 void
 displayData(int16_t height_percent, int32_t display_deg, duty_cycle_s heli_duty)
 {
-    char string[17];  // 16 characters across the display
+    char string[DISPLAY_COLS + 1];  // 16 characters across the display
 
     // Print each line of OLED display data
     usnprintf (string, sizeof(string), "Height   %5d%%", height_percent);
-    OLEDStringDraw (string, 0, 0);
+    displayLine (string, 0);
     usnprintf (string, sizeof(string), "Yaw (deg) %5d", display_deg);
-    OLEDStringDraw (string, 0, 1);
+    displayLine (string, 1);
     usnprintf (string, sizeof(string), "Main Duty %5d%%", heli_duty.main);
-    OLEDStringDraw (string, 0, 2);
+    displayLine (string, 2);
     usnprintf (string, sizeof(string), "Tail Duty %5d%%", heli_duty.tail);
-    OLEDStringDraw (string, 0, 3);
+    displayLine (string, 3);
 }
 
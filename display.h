@@ -6,7 +6,8 @@
 //
 // Functionality for displaying helicopter data using
 // OLED display. Displays current height and yaw, as well
-// as main and tail duty cycles.
+// as main and tail duty cycles. Only changed characters are
+// redrawn; DISPLAY_MAX_RATE_HZ sets how often the main loop refreshes.
 //
 // Authors: T.R. Peterson, M.G. Gardyne, M. Comber
 // Last modified:  19/5/2021
@@ -17,6 +18,13 @@
 #include <stdbool.h>
 #include "responseControl.h"
 
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#ifndef DISPLAY_MAX_RATE_HZ
+#define DISPLAY_MAX_RATE_HZ 10      // Panel refresh rate, at most the SysTick rate
+#endif
+
 //*****************************************************************************
 // Initialise Display Function
 // Code Sourced from:  P.J. Bones  UCECE
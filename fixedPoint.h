@@ -0,0 +1,91 @@
+#ifndef FIXEDPOINT_H_
+#define FIXEDPOINT_H_
+
+// *******************************************************
+// fixedPoint.h
+//
+// Saturating Q8.24 fixed point arithmetic for the PI controllers. A q24_t
+// holds values from -128 to just under +128 with a resolution of 2^-24,
+// which keeps integral gains as small as 0.0000375 to 0.02% accuracy.
+// Functions are inline as they are used in the 2 kHz control interrupt.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+
+//*****************************************************************************
+// Type definitions and constants
+//*****************************************************************************
+typedef int32_t q24_t;
+
+#define Q24_SHIFT           24
+#define Q24_MAX             INT32_MAX
+#define Q24_MIN             INT32_MIN
+
+// Conversion of a constant, rounded to nearest
+#define Q24_FROM_FLOAT(x)   ((q24_t) ((x) * (float) (1 << Q24_SHIFT) + ((x) >= 0 ? 0.5f : -0.5f)))
+
+//*****************************************************************************
+// Saturate a 64 bit intermediate to the q24_t range
+//*****************************************************************************
+static inline q24_t
+q24Saturate (int64_t value)
+{
+    if (value > Q24_MAX)
+        return Q24_MAX;
+    if (value < Q24_MIN)
+        return Q24_MIN;
+    return (q24_t) value;
+}
+
+//*****************************************************************************
+// Integer to q24_t, saturating outside -128 to 127
+//*****************************************************************************
+static inline q24_t
+q24FromInt (int32_t value)
+{
+    return q24Saturate ((int64_t) value << Q24_SHIFT);
+}
+
+//*****************************************************************************
+// q24_t to integer, truncating towards zero as a float to int conversion does
+//*****************************************************************************
+static inline int32_t
+q24ToInt (q24_t value)
+{
+    if (value < 0)
+        return -(int32_t) (-(int64_t) value >> Q24_SHIFT);
+    return value >> Q24_SHIFT;
+}
+
+//*****************************************************************************
+// Saturating add
+//*****************************************************************************
+static inline q24_t
+q24Add (q24_t a, q24_t b)
+{
+    return q24Saturate ((int64_t) a + b);
+}
+
+//*****************************************************************************
+// Saturating product of a q24_t gain and an integer
+//*****************************************************************************
+static inline q24_t
+q24MulInt (q24_t gain, int32_t value)
+{
+    return q24Saturate ((int64_t) gain * value);
+}
+
+//*****************************************************************************
+// Saturating product of two q24_t values, truncated towards minus infinity
+//*****************************************************************************
+static inline q24_t
+q24Mul (q24_t a, q24_t b)
+{
+    return q24Saturate (((int64_t) a * b) >> Q24_SHIFT);
+}
+
+#endif /* FIXEDPOINT_H_ */
@@ -17,10 +17,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include "inc/hw_memmap.h"
-#include "driverlib/gpio.h"
-#include "driverlib/sysctl.h"
 #include "flight_mode.h"
+#include "hal.h"
 
 //*****************************************************************************
 // Enumerated types
@@ -48,10 +46,7 @@ initSwitches (void)
     int i;
 
     // UP button (active HIGH)
-    SysCtlPeripheralEnable (SWITCH_ONE_PERIPH);
-    GPIOPinTypeGPIOInput (SWITCH_ONE_PORT_BASE, SWITCH_ONE_PIN);
-    GPIOPadConfigSet (SWITCH_ONE_PORT_BASE, SWITCH_ONE_PIN, GPIO_STRENGTH_2MA,
-       GPIO_PIN_TYPE_STD_WPD);
+    halSwitchInit ();
     switch_normal[ONE] = SWITCH_ONE_NORMAL; // Low at begining when switch is down
 
     // Sets initial switch value to false
@@ -74,7 +69,7 @@ updateSwitches (void)
     int i;
 
     // Read the pins; true means HIGH, false means LOW
-    switch_value[ONE] = (GPIOPinRead (SWITCH_ONE_PORT_BASE, SWITCH_ONE_PIN) == SWITCH_ONE_PIN);
+    switch_value[ONE] = halSwitchRead ();
 
     // Iterate through the buttons, updating button variables as required
     for (i = 0; i < NUM_SWITCHES; i++)
@@ -38,6 +38,7 @@ typedef enum {
     initialising,
     flying,
     landing,
+    autotuning,     // Relay experiments for the PI gains (autotune.h)
 } flight_mode;
 
 //*****************************************************************************
@@ -0,0 +1,75 @@
+//*****************************************************************************
+//
+// gainSchedule.c
+//
+// Height gain schedule: linear interpolation in the generated gainTable.h.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gainSchedule.h"
+#include "gainTable.h"
+
+_Static_assert (GAIN_TABLE_LEN >= 1 && GAIN_TABLE_LEN <= GAIN_TABLE_MAX_LEN,
+                "gain table length");
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+static uint32_t direction = GAIN_UP;        // Table in use
+
+//*****************************************************************************
+// Interpolate between two gains
+//*****************************************************************************
+static float
+gainLerp (float from, float to, float fraction)
+{
+    return from + (to - from) * fraction;
+}
+
+//*****************************************************************************
+// Gains for a height and direction of travel
+//*****************************************************************************
+void
+gainScheduleLookup (int32_t height, int32_t height_error, pi_gains_s *gains)
+{
+    const pi_gains_s *table;
+    const pi_gains_s *below;
+    const pi_gains_s *above;
+    float fraction;
+    uint32_t i;
+
+#if GAIN_TABLE_DIRECTIONS == GAIN_DIRECTIONS
+    if (height_error > GAIN_DIRECTION_BAND)
+        direction = GAIN_UP;
+    else if (height_error < -GAIN_DIRECTION_BAND)
+        direction = GAIN_DOWN;
+#endif
+    table = gain_table[direction];
+
+    // Hold the end rows beyond the table
+    if (height <= gain_table_height[0]) {
+        *gains = table[0];
+        return;
+    }
+    if (height >= gain_table_height[GAIN_TABLE_LEN - 1]) {
+        *gains = table[GAIN_TABLE_LEN - 1];
+        return;
+    }
+
+    // Rows either side of the height
+    for (i = 1; height > gain_table_height[i]; i++)
+        ;
+    below = &table[i - 1];
+    above = &table[i];
+    fraction = (float) (height - gain_table_height[i - 1]) /
+               (gain_table_height[i] - gain_table_height[i - 1]);
+
+    gains->proportional_main = gainLerp (below->proportional_main, above->proportional_main, fraction);
+    gains->integral_main = gainLerp (below->integral_main, above->integral_main, fraction);
+    gains->proportional_tail = gainLerp (below->proportional_tail, above->proportional_tail, fraction);
+    gains->integral_tail = gainLerp (below->integral_tail, above->integral_tail, fraction);
+}
@@ -0,0 +1,49 @@
+#ifndef GAINSCHEDULE_H_
+#define GAINSCHEDULE_H_
+
+// *******************************************************
+// gainSchedule.h
+//
+// Height gain schedule for the PI controllers, built in with
+// -DGAIN_SCHEDULE. The gains while flying are interpolated from a table of
+// rows by height, optionally separate for climbing and descending, that
+// tools/gainGen.c generates as gainTable.h from the tuning file
+// gainSchedule.txt. Rows can be filled in by running autotune (autotune.h)
+// at each height in a build without the schedule.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "responseControl.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define GAIN_TABLE_MAX_LEN      16      // Rows in each direction's table
+#define GAIN_DIRECTION_BAND     2       // Height error (%) that changes the direction
+
+// Direction of travel, indexing the tables
+#define GAIN_UP                 0
+#define GAIN_DOWN               1
+#define GAIN_DIRECTIONS         2
+
+// The schedule sets the gains every control update while flying, so gains
+// found by autotune would never be flown on
+#if defined(GAIN_SCHEDULE) && defined(AUTOTUNE)
+#error "Autotune the rows in a build without GAIN_SCHEDULE"
+#endif
+
+//*****************************************************************************
+// Gains for a height (%) and the height error (target less current, %)
+// giving the direction of travel. The direction only changes once the
+// error is outside GAIN_DIRECTION_BAND, so it does not chatter at a
+// setpoint.
+//*****************************************************************************
+void
+gainScheduleLookup (int32_t height, int32_t height_error, pi_gains_s *gains);
+
+#endif /* GAINSCHEDULE_H_ */
@@ -0,0 +1,27 @@
+#ifndef GAINTABLE_H_
+#define GAINTABLE_H_
+
+// Generated from gainSchedule.txt by tools/gainGen.c; edit that file and regenerate.
+// Integral gains are per control step.
+
+#define GAIN_TABLE_LEN          2
+#define GAIN_TABLE_DIRECTIONS   2
+
+static const int16_t gain_table_height[GAIN_TABLE_LEN] = { 0, 100 };
+
+static const pi_gains_s gain_table[GAIN_TABLE_DIRECTIONS][GAIN_TABLE_LEN] = {
+    {   // up
+        { .proportional_main = 6.500000e-01f, .integral_main = 1.000000e-04f,
+          .proportional_tail = 6.000000e-01f, .integral_tail = 3.750000e-05f },
+        { .proportional_main = 6.500000e-01f, .integral_main = 1.000000e-04f,
+          .proportional_tail = 6.000000e-01f, .integral_tail = 3.750000e-05f },
+    },
+    {   // down
+        { .proportional_main = 4.500000e-01f, .integral_main = 1.000000e-04f,
+          .proportional_tail = 6.000000e-01f, .integral_tail = 3.750000e-05f },
+        { .proportional_main = 4.500000e-01f, .integral_main = 1.000000e-04f,
+          .proportional_tail = 6.000000e-01f, .integral_tail = 3.750000e-05f },
+    },
+};
+
+#endif /* GAINTABLE_H_ */
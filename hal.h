@@ -0,0 +1,307 @@
+#ifndef HAL_H_
+#define HAL_H_
+
+// *******************************************************
+// hal.h
+//
+// Peripheral abstraction layer for the helicopter. The flight modules only
+// touch the hardware through these functions, so the same control, state
+// machine and filtering code builds either against TivaWare (hal_tiva.c)
+// or as a native Linux process running on a virtual clock (hal_host.c,
+// selected by defining HAL_HOST).
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// String formatting used by the display and UART modules. TivaWare's
+// ustdlib versions are used on target, the C library ones on the host.
+#ifdef HAL_HOST
+#include <stdio.h>
+#define usprintf            sprintf
+#define usnprintf           snprintf
+#else
+#include "utils/ustdlib.h"
+#endif
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define HAL_ADC_BURST_LEN   8       // Steps in ADC0 sequence 0
+#define HAL_LATENCY_UNKNOWN UINT32_MAX  // No timestamp for the interrupt's trigger
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef void (*hal_handler_t)(void);    // Interrupt handler
+
+typedef enum {
+    HAL_INT_SYSTICK,
+    HAL_INT_CONTROL_TIMER,
+    HAL_INT_ADC,
+    HAL_INT_YAW_QUAD,
+    HAL_INT_COUNT
+} hal_int_t;                            // Interrupts with latency measurement
+
+//*****************************************************************************
+// System: clock, delays, resets and interrupt control
+//*****************************************************************************
+void
+halClockInit (void);
+
+uint32_t
+halClockGet (void);
+
+// Delay for count iterations of a 3 cycle loop (SysCtlDelay semantics)
+void
+halDelay (uint32_t count);
+
+void
+halPeripheralsReset (void);
+
+void
+halIntMasterEnable (void);
+
+void
+halSystemReset (void);
+
+void
+halSysTickInit (uint32_t period, hal_handler_t handler);
+
+// Sleep the processor until an interrupt is pending, then let it run.
+// Returns the clock cycles spent asleep, excluding the interrupt handlers.
+uint32_t
+halIdle (void);
+
+//*****************************************************************************
+// Free running counter for profiling: DWT CYCCNT at the system clock on
+// target, a nanosecond clock on the host. halCycleRate gives counts/second.
+//*****************************************************************************
+void
+halCycleCounterInit (void);
+
+uint32_t
+halCycleCount (void);
+
+uint32_t
+halCycleRate (void);
+
+//*****************************************************************************
+// Time from the event that raised an interrupt to now, in cycle counter
+// units, for use on entry to its handler. Timer interrupts are measured from
+// the timeout; the ADC from its trigger, so including the conversion time.
+// Encoder edges have no timestamp and give HAL_LATENCY_UNKNOWN. With
+// ISR_LATENCY undefined the ADC trigger is not timestamped either.
+//*****************************************************************************
+uint32_t
+halIntLatency (hal_int_t source);
+
+//*****************************************************************************
+// Soft reset pin (PA6)
+//*****************************************************************************
+void
+halSoftResetInit (hal_handler_t handler);
+
+void
+halSoftResetIntClear (void);
+
+//*****************************************************************************
+// Height sensor ADC (ADC0 sequence 3, channel 9 on PE4)
+//*****************************************************************************
+void
+halADCInit (hal_handler_t handler);
+
+void
+halADCTrigger (void);
+
+uint32_t
+halADCGet (void);
+
+void
+halADCIntClear (void);
+
+//*****************************************************************************
+// Height sensor burst: sequence 0 converts channel 9 HAL_ADC_BURST_LEN times
+// per halADCTrigger, interrupting once when all are done. halADCBurstGet
+// copies out the conversions and returns how many there were.
+//*****************************************************************************
+void
+halADCBurstInit (hal_handler_t handler);
+
+uint32_t
+halADCBurstGet (uint32_t *samples);
+
+//*****************************************************************************
+// Hardware averaging of factor (1, 2, 4 ... 64) conversions into each
+// result, for every sequence. Call after the ADC is initialised.
+//*****************************************************************************
+void
+halADCOversample (uint32_t factor);
+
+//*****************************************************************************
+// Start conversions of the initialised sequence (single sample or burst)
+// from a hardware timer (Timer1A) at rate_hz instead of halADCTrigger, so
+// sample spacing does not depend on interrupt timing.
+//*****************************************************************************
+void
+halADCTimerTrigger (uint32_t rate_hz);
+
+//*****************************************************************************
+// Height sensor ADC streaming: sequence 3 triggered by a timer (Timer1A) at
+// rate_hz, each conversion moved by uDMA into alternate halves of a ping-pong
+// buffer of 2 x block_len samples. The handler runs once per completed half
+// and calls halADCStreamComplete, which clears the interrupt, re-arms that
+// half and returns it. The returned samples stay valid for block_len sample
+// periods, until the other half has filled.
+//*****************************************************************************
+void
+halADCStreamInit (uint16_t *buffer, uint32_t block_len, uint32_t rate_hz,
+                  hal_handler_t handler);
+
+const uint16_t *
+halADCStreamComplete (void);
+
+//*****************************************************************************
+// Yaw quadrature pins (PB0, PB1) and reference pin (PC4). A null
+// quad_handler sets up only the reference pin.
+//*****************************************************************************
+void
+halYawPinsInit (hal_handler_t quad_handler, hal_handler_t ref_handler);
+
+void
+halYawPinsRead (bool *a, bool *b);
+
+void
+halYawQuadIntClear (void);
+
+void
+halYawRefIntClear (void);
+
+//*****************************************************************************
+// Encoder edge timing at halClockGet () counts per second, enabled by
+// halYawPinsInit with a quad_handler. Both wrap, so take differences.
+// halYawEdgeTime is for the quad handler: the edge being handled, read on
+// entry on target (the DWT cycle counter), and the edge itself on the
+// host. halYawTime is the same clock now.
+//*****************************************************************************
+uint32_t
+halYawEdgeTime (void);
+
+uint32_t
+halYawTime (void);
+
+//*****************************************************************************
+// Yaw quadrature encoder interface (QEI0, phase A on PD6, B on PD7). The
+// position counts 0 to counts - 1 with wrap around, incrementing for the
+// direction the GPIO decoder treats as clockwise. The velocity is the signed
+// count of edges in the last velocity_period clock cycles.
+//*****************************************************************************
+void
+halQEIInit (uint32_t counts, uint32_t velocity_period);
+
+uint32_t
+halQEIPosition (void);
+
+void
+halQEIPositionSet (uint32_t position);
+
+int32_t
+halQEIVelocity (void);
+
+//*****************************************************************************
+// Flight mode slider switch (PA7)
+//*****************************************************************************
+void
+halSwitchInit (void);
+
+bool
+halSwitchRead (void);
+
+//*****************************************************************************
+// Rotor PWM outputs (main M0PWM7 on PC5, tail M1PWM5 on PF1)
+//*****************************************************************************
+void
+halPWMMainInit (void);
+
+void
+halPWMTailInit (void);
+
+void
+halPWMMainSet (uint32_t period, uint32_t pulse_width);
+
+void
+halPWMTailSet (uint32_t period, uint32_t pulse_width);
+
+void
+halPWMMainEnable (bool enable);
+
+void
+halPWMTailEnable (bool enable);
+
+//*****************************************************************************
+// Control loop timer (Timer0A, periodic)
+//*****************************************************************************
+void
+halControlTimerInit (uint32_t load, hal_handler_t handler);
+
+void
+halControlTimerIntClear (void);
+
+//*****************************************************************************
+// USB serial UART (UART0 on PA0, PA1)
+//*****************************************************************************
+void
+halUARTInit (uint32_t baud);
+
+void
+halUARTCharPut (char c);
+
+//*****************************************************************************
+// Interrupt driven transmit. The TX interrupt is raised when the transmit
+// FIFO drains to a quarter full; halUARTCharPutNonBlocking returns false
+// when the FIFO has no space.
+//*****************************************************************************
+void
+halUARTTxIntInit (hal_handler_t handler);
+
+void
+halUARTTxIntEnable (bool enable);
+
+void
+halUARTTxIntClear (void);
+
+bool
+halUARTCharPutNonBlocking (char c);
+
+// Next received character from the receive FIFO, or -1 if there is none
+int32_t
+halUARTCharGetNonBlocking (void);
+
+//*****************************************************************************
+// Orbit OLED display (16 x 4 characters)
+//*****************************************************************************
+void
+halDisplayInit (void);
+
+void
+halDisplayString (char *str, uint32_t col, uint32_t row);
+
+//*****************************************************************************
+// On-chip EEPROM (2 KB). Addresses are in bytes and word aligned; data is
+// whole 32 bit words. Programming blocks for a few milliseconds per word.
+// Erased words read as 0xFFFFFFFF. Each returns false on failure.
+//*****************************************************************************
+bool
+halEEPROMInit (void);
+
+bool
+halEEPROMRead (uint32_t address, uint32_t *data, uint32_t words);
+
+bool
+halEEPROMWrite (uint32_t address, const uint32_t *data, uint32_t words);
+
+#endif /* HAL_H_ */
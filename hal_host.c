@@ -0,0 +1,1010 @@
+//*****************************************************************************
+//
+// hal_host.c
+//
+// Host (Linux) implementation of the peripheral abstraction layer. Time is a
+// virtual count of system clock cycles which only advances while the
+// firmware delays; the SysTick, control timer and simulation step are fired
+// at their exact virtual deadlines, and ADC and GPIO interrupts are latched
+// and serviced as soon as no other handler is running. Streamed ADC
+// sampling fills the ping-pong buffer one conversion per sample deadline and
+// latches the ADC interrupt as each half completes. A timer triggered ADC
+// converts at each of its deadlines. The quadrature encoder
+// interface counts the same simulated edges as the GPIO pins. OLED text is
+// kept as characters, blocking the caller for the SPI time as OrbitOLED
+// does. The EEPROM is an array, optionally loaded from and saved to a file so that calibration
+// survives between runs. The buttons4 API is also provided here, fed from
+// halHostPushButton.
+//
+// Built with HAL_HOST defined, in place of hal_tiva.c and buttons4.c.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#ifdef HAL_HOST
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+#include "buttons4.h"
+#include "hal.h"
+#include "hal_host.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define HOST_RESET_CLOCK_HZ 16000000    // Precision oscillator before initClock
+#define HOST_CLOCK_HZ       20000000    // Clock set by halClockInit
+#define HOST_UART_FIFO      16          // UART transmit FIFO depth
+#define HOST_UART_BITS      10          // Start, 8 data and stop bits
+#define HOST_UART_TX_LEVEL  4           // FIFO level raising the TX interrupt
+#define HOST_OLED_CHAR_US   64          // SPI time to draw one 8x8 character
+#define HOST_DISPLAY_ROWS   4           // OrbitOLED text grid
+#define HOST_DISPLAY_COLS   16
+#define HOST_EEPROM_WORDS   512         // 2 KB
+#define HOST_EEPROM_WORD_US 110         // Programming time per word
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef struct {
+    hal_handler_t handler;
+    uint32_t period;        // Period in clock cycles
+    uint64_t next;          // Cycle count of the next timeout
+    bool enabled;
+} host_timer_s;
+
+typedef struct {
+    uint32_t period;
+    uint32_t pulse_width;
+    bool enabled;
+} host_pwm_s;
+
+typedef struct {
+    uint32_t counts;        // Position range
+    uint32_t position;
+    uint32_t period;        // Velocity period in clock cycles
+    uint64_t start;         // Cycle count the current period began
+    int32_t edges;          // Signed edges in the current period
+    int32_t velocity;       // Signed edges in the last complete period
+    bool enabled;
+} host_qei_s;
+
+typedef struct {
+    uint16_t *buffer;       // Ping-pong buffer, 2 x block_len samples
+    uint32_t block_len;
+    uint32_t index;         // Next sample in the buffer
+    const uint16_t *done;   // Completed half awaiting the handler
+    bool enabled;
+} host_adc_stream_s;
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+// Virtual clock
+static uint64_t now;                        // Cycles since the start of the run
+static uint32_t clock_hz = HOST_RESET_CLOCK_HZ;
+static double end_seconds;                  // Run length
+static jmp_buf run_jmp;                     // Return point for the end of a run
+
+// Interrupts
+static bool int_enabled;                    // Processor interrupts enabled
+static bool in_isr;                         // A handler is currently running
+static uint32_t isr_count;                  // Handlers run, to end an idle sleep
+static host_timer_s systick;
+static host_timer_s control_timer;
+static hal_handler_t adc_handler;
+static hal_handler_t quad_handler;
+static hal_handler_t ref_handler;
+static hal_handler_t reset_handler;
+static volatile bool adc_pending;
+static volatile bool quad_pending;
+static volatile bool ref_pending;
+static hal_handler_t uart_tx_handler;
+static bool uart_tx_int_enabled;
+static volatile bool uart_tx_pending;
+static uint64_t raised_at[HAL_INT_COUNT];  // Cycle count each interrupt was raised
+
+// Simulation step
+static host_step_t step_fn;
+static uint32_t step_rate;
+static uint64_t step_next;
+
+// Inputs
+static host_adc_t adc_source;
+static uint32_t adc_value;                  // Last completed conversion
+static uint32_t adc_burst[HAL_ADC_BURST_LEN];
+static bool adc_burst_mode;                 // Triggers convert a burst
+static uint32_t adc_oversample = 1;         // Hardware averaging factor
+static host_adc_stream_s adc_stream;
+static host_timer_s adc_timer;              // Hardware ADC trigger
+static bool quad_a;
+static bool quad_b;
+static host_qei_s qei;
+static bool ref_level;
+static bool switch_up;
+static uint8_t button_pushes[NUM_BUTS];
+
+// Outputs
+static host_pwm_s pwm_main;
+static host_pwm_s pwm_tail;
+static char display[HOST_DISPLAY_ROWS][HOST_DISPLAY_COLS + 1];
+static void (*uart_sink)(char c);
+static uint32_t uart_baud;
+static uint64_t uart_idle_at;               // Cycle count the TX FIFO empties
+static uint64_t uart_tx_int_at;             // Cycle count the FIFO reaches the
+                                            // TX interrupt level, 0 if none due
+static char uart_rx[HOST_UART_FIFO];        // Receive FIFO
+static uint32_t uart_rx_head;
+static uint32_t uart_rx_count;
+static uint32_t eeprom[HOST_EEPROM_WORDS];
+static bool eeprom_ready;                   // Erased or loaded
+static const char *eeprom_path;             // File backing the EEPROM, if any
+
+//*****************************************************************************
+// Run a handler as an interrupt, then any interrupts latched meanwhile
+//*****************************************************************************
+static void
+hostServicePending (void)
+{
+    while (int_enabled && !in_isr && (adc_pending || quad_pending || ref_pending ||
+                                       (uart_tx_pending && uart_tx_int_enabled)))
+    {
+        in_isr = true;
+        isr_count++;
+        if (adc_pending) {
+            adc_pending = false;
+            if (adc_handler)
+                adc_handler ();
+        } else if (quad_pending) {
+            quad_pending = false;
+            if (quad_handler)
+                quad_handler ();
+        } else if (ref_pending) {
+            ref_pending = false;
+            if (ref_handler)
+                ref_handler ();
+        } else {
+            uart_tx_pending = false;
+            if (uart_tx_handler)
+                uart_tx_handler ();
+        }
+        in_isr = false;
+    }
+}
+
+static void
+hostInterrupt (hal_handler_t handler)
+{
+    if (!int_enabled || in_isr || !handler)
+        return;
+
+    in_isr = true;
+    isr_count++;
+    handler ();
+    in_isr = false;
+
+    hostServicePending ();
+}
+
+//*****************************************************************************
+// One ADC result, averaging oversampled conversions as the hardware does
+//*****************************************************************************
+static uint32_t
+hostADCConvert (void)
+{
+    uint32_t sum = 0;
+    uint32_t i;
+
+    if (!adc_source)
+        return 0;
+
+    for (i = 0; i < adc_oversample; i++)
+        sum += adc_source ();
+
+    return sum / adc_oversample;
+}
+
+//*****************************************************************************
+// Close any QEI velocity periods that have ended
+//*****************************************************************************
+static void
+hostQEIRoll (void)
+{
+    uint64_t periods;
+
+    if (now < qei.start + qei.period)
+        return;
+
+    periods = (now - qei.start) / qei.period;
+    qei.velocity = periods == 1 ? qei.edges : 0;
+    qei.edges = 0;
+    qei.start += periods * qei.period;
+}
+
+//*****************************************************************************
+// Count a quadrature transition, in clockwise order 00, 01, 11, 10
+//*****************************************************************************
+static void
+hostQEIEdge (bool a, bool b)
+{
+    static const uint8_t phase[4] = {0, 1, 3, 2};   // Index by A:B
+    uint8_t step = (phase[a << 1 | b] - phase[quad_a << 1 | quad_b]) & 3;
+
+    hostQEIRoll ();
+
+    if (step == 1) {
+        qei.position = qei.position + 1 < qei.counts ? qei.position + 1 : 0;
+        qei.edges++;
+    } else if (step == 3) {
+        qei.position = qei.position ? qei.position - 1 : qei.counts - 1;
+        qei.edges--;
+    }
+}
+
+//*****************************************************************************
+// One streamed conversion, as the uDMA would store it
+//*****************************************************************************
+static void
+hostADCStreamSample (void)
+{
+    adc_stream.buffer[adc_stream.index++] = hostADCConvert ();
+
+    if (adc_stream.index % adc_stream.block_len == 0) {
+        adc_stream.done = adc_stream.buffer + adc_stream.index - adc_stream.block_len;
+        if (adc_stream.index == 2 * adc_stream.block_len)
+            adc_stream.index = 0;
+        raised_at[HAL_INT_ADC] = now;
+        adc_pending = true;
+        hostServicePending ();
+    }
+}
+
+//*****************************************************************************
+// The earliest timer deadline, if before until
+//*****************************************************************************
+static uint64_t
+hostNextDeadline (uint64_t until)
+{
+    uint64_t next = until;
+
+    if (step_fn && step_next < next)
+        next = step_next;
+    if (systick.enabled && systick.next < next)
+        next = systick.next;
+    if (control_timer.enabled && control_timer.next < next)
+        next = control_timer.next;
+    if (adc_timer.enabled && adc_timer.next < next)
+        next = adc_timer.next;
+    if (uart_tx_int_at && uart_tx_int_at < next)
+        next = uart_tx_int_at;
+
+    return next;
+}
+
+//*****************************************************************************
+// Advance the virtual clock, firing every timer deadline on the way
+//*****************************************************************************
+static void
+hostAdvance (uint64_t until)
+{
+    while (now < until)
+    {
+        uint32_t step_period = step_rate ? clock_hz / step_rate : 0;
+
+        now = hostNextDeadline (until);
+
+        if (step_fn && step_next <= now) {
+            step_next += step_period;
+            step_fn ((double) step_period / clock_hz);
+        }
+        if (systick.enabled && systick.next <= now) {
+            raised_at[HAL_INT_SYSTICK] = systick.next;
+            systick.next += systick.period;
+            hostInterrupt (systick.handler);
+        }
+        if (control_timer.enabled && control_timer.next <= now) {
+            raised_at[HAL_INT_CONTROL_TIMER] = control_timer.next;
+            control_timer.next += control_timer.period;
+            hostInterrupt (control_timer.handler);
+        }
+        if (adc_timer.enabled && adc_timer.next <= now) {
+            adc_timer.next += adc_timer.period;
+            if (adc_stream.enabled)
+                hostADCStreamSample ();
+            else
+                halADCTrigger ();
+        }
+        if (uart_tx_int_at && uart_tx_int_at <= now) {
+            uart_tx_int_at = 0;
+            uart_tx_pending = true;
+            hostServicePending ();
+        }
+
+        if (halHostSeconds () >= end_seconds)
+            longjmp (run_jmp, 1 + HOST_RUN_TIMEOUT);
+    }
+}
+
+//*****************************************************************************
+// Simulator interface
+//*****************************************************************************
+int
+halHostRun (int (*entry)(void), double seconds)
+{
+    int jumped;
+
+    end_seconds = seconds;
+    jumped = setjmp (run_jmp);
+    if (jumped) {
+        in_isr = false;
+        return jumped - 1;
+    }
+
+    entry ();
+
+    return HOST_RUN_TIMEOUT;
+}
+
+uint64_t
+halHostCycles (void)
+{
+    return now;
+}
+
+double
+halHostSeconds (void)
+{
+    return (double) now / clock_hz;
+}
+
+void
+halHostSetStep (host_step_t step, uint32_t rate_hz)
+{
+    step_fn = step;
+    step_rate = rate_hz;
+    step_next = now;
+}
+
+void
+halHostSetADCSource (host_adc_t source)
+{
+    adc_source = source;
+}
+
+void
+halHostSetQuad (bool a, bool b)
+{
+    if (a == quad_a && b == quad_b)
+        return;
+
+    if (qei.enabled)
+        hostQEIEdge (a, b);
+
+    quad_a = a;
+    quad_b = b;
+    raised_at[HAL_INT_YAW_QUAD] = now;
+    quad_pending = true;
+    hostServicePending ();
+}
+
+void
+halHostSetRef (bool level)
+{
+    if (level && !ref_level) {
+        ref_pending = true;
+    }
+    ref_level = level;
+    hostServicePending ();
+}
+
+void
+halHostSetSwitch (bool up)
+{
+    switch_up = up;
+}
+
+void
+halHostPushButton (uint8_t button)
+{
+    if (button < NUM_BUTS)
+        button_pushes[button]++;
+}
+
+float
+halHostPWMMainDuty (void)
+{
+    if (!pwm_main.enabled || pwm_main.period == 0)
+        return 0;
+
+    return 100.0f * pwm_main.pulse_width / pwm_main.period;
+}
+
+float
+halHostPWMTailDuty (void)
+{
+    if (!pwm_tail.enabled || pwm_tail.period == 0)
+        return 0;
+
+    return 100.0f * pwm_tail.pulse_width / pwm_tail.period;
+}
+
+void
+halHostDisplayDump (FILE *out)
+{
+    uint32_t row;
+
+    for (row = 0; row < HOST_DISPLAY_ROWS; row++)
+        fprintf (out, "%s\n", display[row]);
+}
+
+void
+halHostSetUARTSink (void (*sink)(char c))
+{
+    uart_sink = sink;
+}
+
+//*****************************************************************************
+// EEPROM contents, loaded from path if it exists and saved there on writes
+//*****************************************************************************
+static void
+hostEEPROMErase (void)
+{
+    memset (eeprom, 0xFF, sizeof (eeprom));
+    eeprom_ready = true;
+}
+
+void
+halHostEEPROMFile (const char *path)
+{
+    FILE *file;
+
+    hostEEPROMErase ();
+    eeprom_path = path;
+
+    file = fopen (path, "rb");
+    if (file) {
+        if (fread (eeprom, 1, sizeof (eeprom), file) != sizeof (eeprom))
+            hostEEPROMErase ();
+        fclose (file);
+    }
+}
+
+void
+halHostUARTReceive (char c)
+{
+    // Characters arriving at a full FIFO are lost, as on target
+    if (uart_rx_count == HOST_UART_FIFO)
+        return;
+
+    uart_rx[(uart_rx_head + uart_rx_count) % HOST_UART_FIFO] = c;
+    uart_rx_count++;
+}
+
+//*****************************************************************************
+// System
+//*****************************************************************************
+void
+halClockInit (void)
+{
+    clock_hz = HOST_CLOCK_HZ;
+}
+
+uint32_t
+halClockGet (void)
+{
+    return clock_hz;
+}
+
+void
+halDelay (uint32_t count)
+{
+    hostAdvance (now + 3 * (uint64_t) count);
+}
+
+void
+halPeripheralsReset (void)
+{
+}
+
+void
+halIntMasterEnable (void)
+{
+    int_enabled = true;
+    hostServicePending ();
+}
+
+void
+halSystemReset (void)
+{
+    longjmp (run_jmp, 1 + HOST_RUN_RESET);
+}
+
+void
+halSysTickInit (uint32_t period, hal_handler_t handler)
+{
+    systick.handler = handler;
+    systick.period = period;
+    systick.next = now + period;
+    systick.enabled = true;
+}
+
+uint32_t
+halIdle (void)
+{
+    uint64_t start = now;
+    uint32_t count = isr_count;
+
+    // Step from deadline to deadline until one of them runs a handler
+    while (isr_count == count)
+        hostAdvance (hostNextDeadline (UINT64_MAX));
+
+    return now - start;
+}
+
+//*****************************************************************************
+// Profiling counter: real (not virtual) time, so it measures host execution
+//*****************************************************************************
+void
+halCycleCounterInit (void)
+{
+}
+
+uint32_t
+halCycleCount (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (uint32_t) ((uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+uint32_t
+halCycleRate (void)
+{
+    return 1000000000u;
+}
+
+//*****************************************************************************
+// Latency in virtual time, which handlers do not advance, so only masking
+// and waiting behind other handlers show; encoder edges are timestamped too
+//*****************************************************************************
+uint32_t
+halIntLatency (hal_int_t source)
+{
+    if (source >= HAL_INT_COUNT)
+        return HAL_LATENCY_UNKNOWN;
+
+    return (now - raised_at[source]) * 1000000000u / clock_hz;
+}
+
+void
+halSoftResetInit (hal_handler_t handler)
+{
+    reset_handler = handler;
+}
+
+void
+halSoftResetIntClear (void)
+{
+}
+
+//*****************************************************************************
+// Height sensor ADC
+//*****************************************************************************
+void
+halADCInit (hal_handler_t handler)
+{
+    adc_handler = handler;
+    adc_burst_mode = false;
+}
+
+void
+halADCTrigger (void)
+{
+    uint32_t i;
+
+    // Conversion time is negligible next to the sample period
+    if (adc_burst_mode) {
+        for (i = 0; i < HAL_ADC_BURST_LEN; i++)
+            adc_burst[i] = hostADCConvert ();
+    } else {
+        adc_value = hostADCConvert ();
+    }
+    raised_at[HAL_INT_ADC] = now;
+    adc_pending = true;
+    hostServicePending ();
+}
+
+uint32_t
+halADCGet (void)
+{
+    return adc_value;
+}
+
+void
+halADCIntClear (void)
+{
+}
+
+void
+halADCBurstInit (hal_handler_t handler)
+{
+    adc_handler = handler;
+    adc_burst_mode = true;
+}
+
+uint32_t
+halADCBurstGet (uint32_t *samples)
+{
+    memcpy (samples, adc_burst, sizeof (adc_burst));
+    return HAL_ADC_BURST_LEN;
+}
+
+void
+halADCOversample (uint32_t factor)
+{
+    adc_oversample = factor ? factor : 1;
+}
+
+void
+halADCTimerTrigger (uint32_t rate_hz)
+{
+    adc_timer.period = clock_hz / rate_hz;
+    adc_timer.next = now + adc_timer.period;
+    adc_timer.enabled = true;
+}
+
+void
+halADCStreamInit (uint16_t *buffer, uint32_t block_len, uint32_t rate_hz,
+                  hal_handler_t handler)
+{
+    adc_handler = handler;
+    adc_stream.buffer = buffer;
+    adc_stream.block_len = block_len;
+    adc_stream.index = 0;
+    adc_stream.done = 0;
+    adc_stream.enabled = true;
+    halADCTimerTrigger (rate_hz);
+}
+
+const uint16_t *
+halADCStreamComplete (void)
+{
+    const uint16_t *block = adc_stream.done;
+
+    adc_stream.done = 0;
+    return block;
+}
+
+//*****************************************************************************
+// Yaw pins
+//*****************************************************************************
+void
+halYawPinsInit (hal_handler_t quad, hal_handler_t ref)
+{
+    quad_handler = quad;
+    ref_handler = ref;
+}
+
+void
+halYawPinsRead (bool *a, bool *b)
+{
+    *a = quad_a;
+    *b = quad_b;
+}
+
+void
+halYawQuadIntClear (void)
+{
+}
+
+void
+halYawRefIntClear (void)
+{
+}
+
+uint32_t
+halYawEdgeTime (void)
+{
+    return (uint32_t) raised_at[HAL_INT_YAW_QUAD];
+}
+
+uint32_t
+halYawTime (void)
+{
+    return (uint32_t) now;
+}
+
+//*****************************************************************************
+// Quadrature encoder interface
+//*****************************************************************************
+void
+halQEIInit (uint32_t counts, uint32_t velocity_period)
+{
+    qei.counts = counts;
+    qei.position = 0;
+    qei.period = velocity_period;
+    qei.start = now;
+    qei.edges = 0;
+    qei.velocity = 0;
+    qei.enabled = true;
+}
+
+uint32_t
+halQEIPosition (void)
+{
+    return qei.position;
+}
+
+void
+halQEIPositionSet (uint32_t position)
+{
+    qei.position = position;
+}
+
+int32_t
+halQEIVelocity (void)
+{
+    hostQEIRoll ();
+    return qei.velocity;
+}
+
+//*****************************************************************************
+// Switch
+//*****************************************************************************
+void
+halSwitchInit (void)
+{
+}
+
+bool
+halSwitchRead (void)
+{
+    return switch_up;
+}
+
+//*****************************************************************************
+// PWM
+//*****************************************************************************
+void
+halPWMMainInit (void)
+{
+    pwm_main.enabled = false;
+}
+
+void
+halPWMTailInit (void)
+{
+    pwm_tail.enabled = false;
+}
+
+void
+halPWMMainSet (uint32_t period, uint32_t pulse_width)
+{
+    pwm_main.period = period;
+    pwm_main.pulse_width = pulse_width;
+}
+
+void
+halPWMTailSet (uint32_t period, uint32_t pulse_width)
+{
+    pwm_tail.period = period;
+    pwm_tail.pulse_width = pulse_width;
+}
+
+void
+halPWMMainEnable (bool enable)
+{
+    pwm_main.enabled = enable;
+}
+
+void
+halPWMTailEnable (bool enable)
+{
+    pwm_tail.enabled = enable;
+}
+
+//*****************************************************************************
+// Control timer
+//*****************************************************************************
+void
+halControlTimerInit (uint32_t load, hal_handler_t handler)
+{
+    control_timer.handler = handler;
+    control_timer.period = load;
+    control_timer.next = now + load;
+    control_timer.enabled = true;
+}
+
+void
+halControlTimerIntClear (void)
+{
+}
+
+//*****************************************************************************
+// UART, blocking the caller while the transmit FIFO is full
+//*****************************************************************************
+void
+halUARTInit (uint32_t baud)
+{
+    uart_baud = baud;
+    uart_idle_at = now;
+}
+
+void
+halUARTCharPut (char c)
+{
+    uint64_t char_cycles = (uint64_t) clock_hz * HOST_UART_BITS / uart_baud;
+
+    // Wait for space in the FIFO
+    if (uart_idle_at > now + HOST_UART_FIFO * char_cycles)
+        hostAdvance (uart_idle_at - HOST_UART_FIFO * char_cycles);
+
+    if (uart_idle_at < now)
+        uart_idle_at = now;
+    uart_idle_at += char_cycles;
+
+    if (uart_sink)
+        uart_sink (c);
+}
+
+void
+halUARTTxIntInit (hal_handler_t handler)
+{
+    uart_tx_handler = handler;
+}
+
+void
+halUARTTxIntEnable (bool enable)
+{
+    uart_tx_int_enabled = enable;
+    hostServicePending ();
+}
+
+void
+halUARTTxIntClear (void)
+{
+    uart_tx_pending = false;
+}
+
+bool
+halUARTCharPutNonBlocking (char c)
+{
+    uint64_t char_cycles = (uint64_t) clock_hz * HOST_UART_BITS / uart_baud;
+    uint64_t level_at;
+
+    if (uart_idle_at > now + (HOST_UART_FIFO - 1) * char_cycles)
+        return false;
+
+    if (uart_idle_at < now)
+        uart_idle_at = now;
+    uart_idle_at += char_cycles;
+
+    // The TX interrupt is raised as the FIFO drains through its level
+    level_at = uart_idle_at - HOST_UART_TX_LEVEL * char_cycles;
+    if (level_at > now)
+        uart_tx_int_at = level_at;
+
+    if (uart_sink)
+        uart_sink (c);
+
+    return true;
+}
+
+int32_t
+halUARTCharGetNonBlocking (void)
+{
+    char c;
+
+    if (uart_rx_count == 0)
+        return -1;
+
+    c = uart_rx[uart_rx_head];
+    uart_rx_head = (uart_rx_head + 1) % HOST_UART_FIFO;
+    uart_rx_count--;
+
+    return (uint8_t) c;
+}
+
+//*****************************************************************************
+// Display
+//*****************************************************************************
+void
+halDisplayInit (void)
+{
+    memset (display, ' ', sizeof (display));
+    for (int row = 0; row < HOST_DISPLAY_ROWS; row++)
+        display[row][HOST_DISPLAY_COLS] = '\0';
+}
+
+void
+halDisplayString (char *str, uint32_t col, uint32_t row)
+{
+    uint32_t drawn = 0;
+
+    if (row >= HOST_DISPLAY_ROWS)
+        return;
+
+    while (*str && col < HOST_DISPLAY_COLS) {
+        display[row][col++] = *str++;
+        drawn++;
+    }
+
+    // The caller is blocked while the characters are clocked out over SPI
+    if (!in_isr)
+        hostAdvance (now + (uint64_t) drawn * HOST_OLED_CHAR_US * (clock_hz / 1000000));
+}
+
+//*****************************************************************************
+// EEPROM
+//*****************************************************************************
+bool
+halEEPROMInit (void)
+{
+    if (!eeprom_ready)
+        hostEEPROMErase ();
+    return true;
+}
+
+bool
+halEEPROMRead (uint32_t address, uint32_t *data, uint32_t words)
+{
+    if (address % 4 || address / 4 + words > HOST_EEPROM_WORDS)
+        return false;
+
+    memcpy (data, &eeprom[address / 4], words * 4);
+    return true;
+}
+
+bool
+halEEPROMWrite (uint32_t address, const uint32_t *data, uint32_t words)
+{
+    FILE *file;
+
+    if (address % 4 || address / 4 + words > HOST_EEPROM_WORDS)
+        return false;
+
+    // Programming blocks the caller
+    hostAdvance (now + (uint64_t) words * HOST_EEPROM_WORD_US * clock_hz / 1000000);
+    memcpy (&eeprom[address / 4], data, words * 4);
+
+    if (eeprom_path) {
+        file = fopen (eeprom_path, "wb");
+        if (!file)
+            return false;
+        fwrite (eeprom, 1, sizeof (eeprom), file);
+        fclose (file);
+    }
+
+    return true;
+}
+
+//*****************************************************************************
+// buttons4 API, with pushes injected by the simulator
+//*****************************************************************************
+void
+initButtons (void)
+{
+    memset (button_pushes, 0, sizeof (button_pushes));
+}
+
+void
+updateButtons (void)
+{
+}
+
+uint8_t
+checkButton (uint8_t butName)
+{
+    if (butName < NUM_BUTS && button_pushes[butName]) {
+        button_pushes[butName]--;
+        return PUSHED;
+    }
+    return NO_CHANGE;
+}
+
+#endif /* HAL_HOST */
@@ -0,0 +1,96 @@
+#ifndef HAL_HOST_H_
+#define HAL_HOST_H_
+
+// *******************************************************
+// hal_host.h
+//
+// Simulation side of the host (Linux) peripheral abstraction layer. The
+// firmware sees the normal hal.h interface; a simulator uses these calls to
+// drive the inputs, observe the outputs and run the firmware on a virtual
+// clock that advances only when the firmware delays.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define HOST_RUN_TIMEOUT    0   // Run ended when the requested time elapsed
+#define HOST_RUN_RESET      1   // Run ended by a system reset request
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef void (*host_step_t)(double dt);     // Simulation step, dt in seconds
+typedef uint32_t (*host_adc_t)(void);       // Source of ADC conversions
+
+//*****************************************************************************
+// Run the firmware entry point on the virtual clock for the given time
+//*****************************************************************************
+int
+halHostRun (int (*entry)(void), double seconds);
+
+//*****************************************************************************
+// Virtual time since the start of the run
+//*****************************************************************************
+uint64_t
+halHostCycles (void);
+
+double
+halHostSeconds (void);
+
+//*****************************************************************************
+// Register a function called at a fixed rate of virtual time
+//*****************************************************************************
+void
+halHostSetStep (host_step_t step, uint32_t rate_hz);
+
+//*****************************************************************************
+// Inputs
+//*****************************************************************************
+void
+halHostSetADCSource (host_adc_t source);
+
+void
+halHostSetQuad (bool a, bool b);
+
+void
+halHostSetRef (bool level);
+
+void
+halHostSetSwitch (bool up);
+
+void
+halHostPushButton (uint8_t button);
+
+// A character arriving on the UART from the host
+void
+halHostUARTReceive (char c);
+
+// Back the EEPROM with a file: loaded now if it exists, saved on each write
+void
+halHostEEPROMFile (const char *path);
+
+//*****************************************************************************
+// Outputs
+//*****************************************************************************
+float
+halHostPWMMainDuty (void);
+
+float
+halHostPWMTailDuty (void);
+
+// Print the text on the OLED panel
+void
+halHostDisplayDump (FILE *out);
+
+void
+halHostSetUARTSink (void (*sink)(char c));
+
+#endif /* HAL_HOST_H_ */
@@ -0,0 +1,809 @@
+//*****************************************************************************
+//
+// hal_tiva.c
+//
+// TivaWare implementation of the peripheral abstraction layer for the
+// TM4C123 helicopter rig. Pin and peripheral assignments are taken from the
+// module headers (pwmGen.h, uart.h, flight_mode.h, buttons4.h).
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// Code Sourced from:  P.J. Bones  UCECE (acknowledged in function descriptions)
+
+#ifndef HAL_HOST
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_adc.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/adc.h"
+#include "driverlib/cpu.h"
+#include "driverlib/eeprom.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/pwm.h"
+#include "driverlib/qei.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/systick.h"
+#include "driverlib/timer.h"
+#include "driverlib/uart.h"
+#include "driverlib/udma.h"
+#include "OrbitOLED/OrbitOLEDInterface.h"
+#include "buttons4.h"
+#include "flight_mode.h"
+#include "pwmGen.h"
+#include "uart.h"
+#include "hal.h"
+
+//*****************************************************************************
+// SysTick period, used to time idle sleeps and interrupt latency
+//*****************************************************************************
+static uint32_t systick_period;
+
+//*****************************************************************************
+// ADC trigger, for interrupt latency
+//*****************************************************************************
+static bool adc_timer_triggered;            // Converted on Timer1A timeouts
+#ifdef ISR_LATENCY
+static volatile uint32_t adc_trigger_at;    // Cycle count of the last processor trigger
+#endif
+
+//*****************************************************************************
+// Initialisation function for the clock
+// Sourced from:  P.J. Bones  UCECE
+//*****************************************************************************
+void
+halClockInit (void)
+{
+    // Set the clock rate to 20 MHz
+    SysCtlClockSet (SYSCTL_SYSDIV_10 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN |
+                   SYSCTL_XTAL_16MHZ);
+}
+
+uint32_t
+halClockGet (void)
+{
+    return SysCtlClockGet ();
+}
+
+void
+halDelay (uint32_t count)
+{
+    SysCtlDelay (count);
+}
+
+//*****************************************************************************
+// As a precaution, make sure that the peripherals used are reset
+//*****************************************************************************
+void
+halPeripheralsReset (void)
+{
+    SysCtlPeripheralReset (LEFT_BUT_PERIPH);
+    SysCtlPeripheralReset (UP_BUT_PERIPH);
+    SysCtlPeripheralReset (SYSCTL_PERIPH_GPIOB);
+    SysCtlPeripheralReset (SYSCTL_PERIPH_GPIOC);
+    SysCtlPeripheralReset (UART_USB_PERIPH_UART);
+    SysCtlPeripheralReset (UART_USB_PERIPH_GPIO);
+    SysCtlPeripheralReset (SYSCTL_PERIPH_TIMER0);
+}
+
+void
+halIntMasterEnable (void)
+{
+    IntMasterEnable ();
+}
+
+void
+halSystemReset (void)
+{
+    SysCtlReset ();
+}
+
+//*****************************************************************************
+// Set up the SysTick timer, with the period in system clock cycles
+// Sourced from:  P.J. Bones  UCECE
+//*****************************************************************************
+void
+halSysTickInit (uint32_t period, hal_handler_t handler)
+{
+    systick_period = period;
+
+    // Set up the period for the SysTick timer.
+    SysTickPeriodSet (period);
+    //
+    // Register the interrupt handler
+    SysTickIntRegister (handler);
+    //
+    // Enable interrupt and device
+    SysTickIntEnable ();
+    SysTickEnable ();
+}
+
+//*****************************************************************************
+// Sleep with WFI. Interrupts are masked so the pending handler runs only
+// after the wake time is read; WFI still wakes on a masked interrupt. The
+// SysTick interrupt wakes the processor at least once per period, so the
+// down counter wraps at most once while asleep.
+//*****************************************************************************
+uint32_t
+halIdle (void)
+{
+    uint32_t start;
+    uint32_t end;
+
+    CPUcpsid ();
+    start = SysTickValueGet ();
+    CPUwfi ();
+    end = SysTickValueGet ();
+    CPUcpsie ();
+
+    return end <= start ? start - end : start + systick_period - end;
+}
+
+//*****************************************************************************
+// Cortex-M4 data watchpoint and trace unit cycle counter
+//*****************************************************************************
+#define DEMCR               0xE000EDFC  // Debug exception and monitor control
+#define DEMCR_TRCENA        0x01000000  // Enable DWT
+#define DWT_CTRL            0xE0001000
+#define DWT_CTRL_CYCCNTENA  0x00000001
+#define DWT_CYCCNT          0xE0001004
+
+void
+halCycleCounterInit (void)
+{
+    HWREG (DEMCR) |= DEMCR_TRCENA;
+    HWREG (DWT_CYCCNT) = 0;
+    HWREG (DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+}
+
+uint32_t
+halCycleCount (void)
+{
+    return HWREG (DWT_CYCCNT);
+}
+
+uint32_t
+halCycleRate (void)
+{
+    return SysCtlClockGet ();
+}
+
+//*****************************************************************************
+// Interrupt latency. The timers count down from their load and reload on
+// timeout, so the count gone since the reload is the time since the
+// interrupt was raised (DWT cycles are system clock cycles).
+//*****************************************************************************
+uint32_t
+halIntLatency (hal_int_t source)
+{
+    switch (source)
+    {
+    case HAL_INT_SYSTICK:
+        return systick_period - 1 - SysTickValueGet ();
+    case HAL_INT_CONTROL_TIMER:
+        return TimerLoadGet (TIMER0_BASE, TIMER_A) - TimerValueGet (TIMER0_BASE, TIMER_A);
+    case HAL_INT_ADC:
+        if (adc_timer_triggered)
+            return TimerLoadGet (TIMER1_BASE, TIMER_A) - TimerValueGet (TIMER1_BASE, TIMER_A);
+#ifdef ISR_LATENCY
+        return HWREG (DWT_CYCCNT) - adc_trigger_at;
+#else
+        return HAL_LATENCY_UNKNOWN;
+#endif
+    default:
+        return HAL_LATENCY_UNKNOWN;
+    }
+}
+
+//*****************************************************************************
+// Soft reset pin (PA6)
+//*****************************************************************************
+void
+halSoftResetInit (hal_handler_t handler)
+{
+    // Enable port peripheral
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_GPIOA);
+
+    // Set pin 6 as input
+    GPIOPinTypeGPIOInput (GPIO_PORTA_BASE, GPIO_PIN_6);
+
+    // Set pad configuration
+    GPIOPadConfigSet (GPIO_PORTA_BASE, GPIO_PIN_6, GPIO_STRENGTH_2MA,
+           GPIO_PIN_TYPE_STD_WPU);
+
+    // Register interrupt
+    GPIOIntRegister (GPIO_PORTA_BASE, handler);
+
+    // Enable pin
+    GPIOIntEnable (GPIO_PORTA_BASE, GPIO_PIN_6);
+}
+
+void
+halSoftResetIntClear (void)
+{
+    GPIOIntClear (GPIO_PORTA_BASE, GPIO_PIN_6);
+}
+
+//*****************************************************************************
+// Sequence triggered by halADCTrigger
+//*****************************************************************************
+static uint32_t adc_sequence = 3;
+
+//*****************************************************************************
+// Initialise ADC functions
+// Sourced from:  P.J. Bones  UCECE
+//*****************************************************************************
+void
+halADCInit (hal_handler_t handler)
+{
+    adc_sequence = 3;
+
+    //
+    // The ADC0 peripheral must be enabled for configuration and use.
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_ADC0);
+
+    // Enable sample sequence 3 with a processor signal trigger.  Sequence 3
+    // will do a single sample when the processor sends a signal to start the
+    // conversion.
+    ADCSequenceConfigure (ADC0_BASE, 3, ADC_TRIGGER_PROCESSOR, 0);
+
+    //
+    // Configure step 0 on sequence 3.  Sample channel 9 (PE4) in single-ended
+    // mode (default) and configure the interrupt flag (ADC_CTL_IE) to be set
+    // when the sample is done.  Tell the ADC logic that this is the last
+    // conversion on sequence 3 (ADC_CTL_END).  Sequence 3 has only one
+    // programmable step.
+    ADCSequenceStepConfigure (ADC0_BASE, 3, 0, ADC_CTL_CH9 | ADC_CTL_IE |
+                             ADC_CTL_END);
+
+    //
+    // Since sample sequence 3 is now configured, it must be enabled.
+    ADCSequenceEnable (ADC0_BASE, 3);
+
+    //
+    // Register the interrupt handler
+    ADCIntRegister (ADC0_BASE, 3, handler);
+
+    //
+    // Enable interrupts for ADC0 sequence 3 (clears any outstanding interrupts)
+    ADCIntEnable (ADC0_BASE, 3);
+}
+
+void
+halADCTrigger (void)
+{
+#ifdef ISR_LATENCY
+    adc_trigger_at = HWREG (DWT_CYCCNT);
+#endif
+    ADCProcessorTrigger (ADC0_BASE, adc_sequence);
+}
+
+uint32_t
+halADCGet (void)
+{
+    uint32_t value;
+
+    // Get the single sample from ADC0 sequence 3
+    ADCSequenceDataGet (ADC0_BASE, 3, &value);
+
+    return value;
+}
+
+void
+halADCIntClear (void)
+{
+    ADCIntClear (ADC0_BASE, adc_sequence);
+}
+
+//*****************************************************************************
+// Initialise sequence 0 to convert channel 9 on all eight steps per trigger
+//*****************************************************************************
+void
+halADCBurstInit (hal_handler_t handler)
+{
+    uint32_t step;
+
+    adc_sequence = 0;
+
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_ADC0);
+    ADCSequenceConfigure (ADC0_BASE, 0, ADC_TRIGGER_PROCESSOR, 0);
+
+    //
+    // Only the last step sets the interrupt flag and ends the sequence
+    for (step = 0; step < HAL_ADC_BURST_LEN - 1; step++)
+        ADCSequenceStepConfigure (ADC0_BASE, 0, step, ADC_CTL_CH9);
+    ADCSequenceStepConfigure (ADC0_BASE, 0, step, ADC_CTL_CH9 | ADC_CTL_IE |
+                             ADC_CTL_END);
+
+    ADCSequenceEnable (ADC0_BASE, 0);
+    ADCIntRegister (ADC0_BASE, 0, handler);
+    ADCIntEnable (ADC0_BASE, 0);
+}
+
+uint32_t
+halADCBurstGet (uint32_t *samples)
+{
+    return ADCSequenceDataGet (ADC0_BASE, 0, samples);
+}
+
+void
+halADCOversample (uint32_t factor)
+{
+    ADCHardwareOversampleConfigure (ADC0_BASE, factor);
+}
+
+//*****************************************************************************
+// Trigger the sequence in use from Timer1A
+//*****************************************************************************
+void
+halADCTimerTrigger (uint32_t rate_hz)
+{
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_TIMER1);
+
+    ADCSequenceDisable (ADC0_BASE, adc_sequence);
+    ADCSequenceConfigure (ADC0_BASE, adc_sequence, ADC_TRIGGER_TIMER, 0);
+    ADCSequenceEnable (ADC0_BASE, adc_sequence);
+
+    TimerConfigure (TIMER1_BASE, TIMER_CFG_PERIODIC);
+    TimerLoadSet (TIMER1_BASE, TIMER_A, SysCtlClockGet () / rate_hz - 1);
+    TimerControlTrigger (TIMER1_BASE, TIMER_A, true);
+    TimerEnable (TIMER1_BASE, TIMER_A);
+    adc_timer_triggered = true;
+}
+
+//*****************************************************************************
+// uDMA channel control table, which must be 1024 byte aligned
+//*****************************************************************************
+#if defined(ccs)
+#pragma DATA_ALIGN(dma_control, 1024)
+static uint8_t dma_control[1024];
+#else
+static uint8_t dma_control[1024] __attribute__ ((aligned (1024)));
+#endif
+
+static uint16_t *stream_buffer;
+static uint32_t stream_block_len;
+
+//*****************************************************************************
+// Point one half of the ping-pong transfer at its block of the buffer
+//*****************************************************************************
+static void
+halADCStreamArm (uint32_t select, uint16_t *block)
+{
+    uDMAChannelTransferSet (UDMA_CHANNEL_ADC3 | select, UDMA_MODE_PINGPONG,
+                            (void *) (ADC0_BASE + ADC_O_SSFIFO3), block,
+                            stream_block_len);
+}
+
+//*****************************************************************************
+// Initialise timer triggered ADC sampling into a uDMA ping-pong buffer
+//*****************************************************************************
+void
+halADCStreamInit (uint16_t *buffer, uint32_t block_len, uint32_t rate_hz,
+                  hal_handler_t handler)
+{
+    stream_buffer = buffer;
+    stream_block_len = block_len;
+    adc_sequence = 3;
+
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_UDMA);
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_ADC0);
+
+    uDMAEnable ();
+    uDMAControlBaseSet (dma_control);
+
+    //
+    // Sequence 3 converts channel 9 once per timer trigger. Each result
+    // raises a uDMA request rather than a processor interrupt.
+    ADCSequenceConfigure (ADC0_BASE, 3, ADC_TRIGGER_TIMER, 0);
+    ADCSequenceStepConfigure (ADC0_BASE, 3, 0, ADC_CTL_CH9 | ADC_CTL_IE |
+                             ADC_CTL_END);
+    ADCSequenceEnable (ADC0_BASE, 3);
+    ADCSequenceDMAEnable (ADC0_BASE, 3);
+
+    //
+    // 16 bit transfers from the sequence FIFO into alternating halves of
+    // the buffer, one item per request
+    uDMAChannelAttributeDisable (UDMA_CHANNEL_ADC3, UDMA_ATTR_ALTSELECT |
+                                 UDMA_ATTR_HIGH_PRIORITY | UDMA_ATTR_REQMASK);
+    uDMAChannelControlSet (UDMA_CHANNEL_ADC3 | UDMA_PRI_SELECT, UDMA_SIZE_16 |
+                           UDMA_SRC_INC_NONE | UDMA_DST_INC_16 | UDMA_ARB_1);
+    uDMAChannelControlSet (UDMA_CHANNEL_ADC3 | UDMA_ALT_SELECT, UDMA_SIZE_16 |
+                           UDMA_SRC_INC_NONE | UDMA_DST_INC_16 | UDMA_ARB_1);
+    halADCStreamArm (UDMA_PRI_SELECT, buffer);
+    halADCStreamArm (UDMA_ALT_SELECT, buffer + block_len);
+    uDMAChannelEnable (UDMA_CHANNEL_ADC3);
+
+    //
+    // On the TM4C123 the uDMA completing a half is signalled on the
+    // sequence 3 vector. The sequence's own interrupt stays masked, so
+    // the conversions themselves do not interrupt.
+    ADCIntRegister (ADC0_BASE, 3, handler);
+
+    //
+    // Timer1A triggers the conversions
+    halADCTimerTrigger (rate_hz);
+}
+
+const uint16_t *
+halADCStreamComplete (void)
+{
+    ADCIntClear (ADC0_BASE, 3);
+
+    // A stopped half has completed; re-arm it to follow the other
+    if (uDMAChannelModeGet (UDMA_CHANNEL_ADC3 | UDMA_PRI_SELECT) == UDMA_MODE_STOP) {
+        halADCStreamArm (UDMA_PRI_SELECT, stream_buffer);
+        return stream_buffer;
+    }
+    if (uDMAChannelModeGet (UDMA_CHANNEL_ADC3 | UDMA_ALT_SELECT) == UDMA_MODE_STOP) {
+        halADCStreamArm (UDMA_ALT_SELECT, stream_buffer + stream_block_len);
+        return stream_buffer + stream_block_len;
+    }
+
+    return 0;
+}
+
+//*************************************************************
+// Intialise GPIO Pins
+// PB0 and PB1 are used for quadrature encoding
+// PC4 is used for reference yaw input
+//*************************************************************
+void
+halYawPinsInit (hal_handler_t quad_handler, hal_handler_t ref_handler)
+{
+    // Reference pin 4 as input, interrupting on the rising edge
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_GPIOC);
+    GPIOPinTypeGPIOInput (GPIO_PORTC_BASE, GPIO_PIN_4);
+    GPIOIntTypeSet (GPIO_PORTC_BASE, GPIO_PIN_4, GPIO_RISING_EDGE);
+    GPIOIntRegister (GPIO_PORTC_BASE, ref_handler);
+    GPIOIntEnable (GPIO_PORTC_BASE, GPIO_PIN_4);
+
+    if (!quad_handler)
+        return;
+
+    // Quadrature pins 0 and 1 as input, interrupting on both edges
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_GPIOB);
+    GPIOPinTypeGPIOInput (GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    GPIOIntTypeSet (GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1, GPIO_BOTH_EDGES);
+    GPIOIntRegister (GPIO_PORTB_BASE, quad_handler);
+    GPIOIntEnable (GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+
+    // Edges are timed by the cycle counter, left running if profiling
+    // has started it
+    HWREG (DEMCR) |= DEMCR_TRCENA;
+    HWREG (DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+}
+
+void
+halYawPinsRead (bool *a, bool *b)
+{
+    *a = GPIOPinRead (GPIO_PORTB_BASE, GPIO_PIN_0);
+    *b = GPIOPinRead (GPIO_PORTB_BASE, GPIO_PIN_1);
+}
+
+void
+halYawQuadIntClear (void)
+{
+    GPIOIntClear (GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+}
+
+void
+halYawRefIntClear (void)
+{
+    GPIOIntClear (GPIO_PORTC_BASE, GPIO_PIN_4);
+}
+
+uint32_t
+halYawEdgeTime (void)
+{
+    return HWREG (DWT_CYCCNT);
+}
+
+uint32_t
+halYawTime (void)
+{
+    return HWREG (DWT_CYCCNT);
+}
+
+//*************************************************************
+// Intialise QEI0 for the yaw encoder
+// PB0 and PB1 are not QEI pins, so the encoder phases must be wired to
+// PD6 and PD7 for this mode. PC4 is the QEI1 index input, but QEI1's
+// phase A pin (PC5) drives the main rotor, so the reference stays a GPIO
+// interrupt.
+//*************************************************************
+void
+halQEIInit (uint32_t counts, uint32_t velocity_period)
+{
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_QEI0);
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_GPIOD);
+
+    // PD7 is locked as an NMI pin until unlocked
+    HWREG (GPIO_PORTD_BASE + GPIO_O_LOCK) = GPIO_LOCK_KEY;
+    HWREG (GPIO_PORTD_BASE + GPIO_O_CR) |= GPIO_PIN_7;
+    HWREG (GPIO_PORTD_BASE + GPIO_O_LOCK) = 0;
+
+    GPIOPinConfigure (GPIO_PD6_PHA0);
+    GPIOPinConfigure (GPIO_PD7_PHB0);
+    GPIOPinTypeQEI (GPIO_PORTD_BASE, GPIO_PIN_6 | GPIO_PIN_7);
+
+    // Count all four edges per cycle. The disc's clockwise sequence has B
+    // leading A, so the phases are swapped to count up clockwise.
+    QEIConfigure (QEI0_BASE, QEI_CONFIG_CAPTURE_A_B | QEI_CONFIG_NO_RESET |
+                  QEI_CONFIG_QUADRATURE | QEI_CONFIG_SWAP, counts - 1);
+
+    QEIVelocityConfigure (QEI0_BASE, QEI_VELDIV_1, velocity_period);
+    QEIVelocityEnable (QEI0_BASE);
+    QEIEnable (QEI0_BASE);
+}
+
+uint32_t
+halQEIPosition (void)
+{
+    return QEIPositionGet (QEI0_BASE);
+}
+
+void
+halQEIPositionSet (uint32_t position)
+{
+    QEIPositionSet (QEI0_BASE, position);
+}
+
+int32_t
+halQEIVelocity (void)
+{
+    return QEIDirectionGet (QEI0_BASE) * (int32_t) QEIVelocityGet (QEI0_BASE);
+}
+
+//*****************************************************************************
+// Initialise switch
+// Sourced from: P.J. Bones UCECE
+//*****************************************************************************
+void
+halSwitchInit (void)
+{
+    SysCtlPeripheralEnable (SWITCH_ONE_PERIPH);
+    GPIOPinTypeGPIOInput (SWITCH_ONE_PORT_BASE, SWITCH_ONE_PIN);
+    GPIOPadConfigSet (SWITCH_ONE_PORT_BASE, SWITCH_ONE_PIN, GPIO_STRENGTH_2MA,
+       GPIO_PIN_TYPE_STD_WPD);
+}
+
+bool
+halSwitchRead (void)
+{
+    return (GPIOPinRead (SWITCH_ONE_PORT_BASE, SWITCH_ONE_PIN) == SWITCH_ONE_PIN);
+}
+
+/*********************************************************
+ * M0PWM7 (J4-05, PC5) is used for the main rotor motor
+ *********************************************************/
+void
+halPWMMainInit (void)
+{
+    // As a precaution, make sure that the peripherals used are reset
+    SysCtlPeripheralReset (PWM_MAIN_PERIPH_GPIO);
+    SysCtlPeripheralReset (PWM_MAIN_PERIPH_PWM);
+
+    SysCtlPeripheralEnable (PWM_MAIN_PERIPH_PWM);
+    SysCtlPeripheralEnable (PWM_MAIN_PERIPH_GPIO);
+
+    GPIOPinConfigure (PWM_MAIN_GPIO_CONFIG);
+    GPIOPinTypePWM (PWM_MAIN_GPIO_BASE, PWM_MAIN_GPIO_PIN);
+
+    PWMGenConfigure (PWM_MAIN_BASE, PWM_MAIN_GEN,
+                    PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_NO_SYNC);
+
+    PWMGenEnable (PWM_MAIN_BASE, PWM_MAIN_GEN);
+
+    // Disable the output.  Repeat this call with 'true' to turn O/P on.
+    PWMOutputState (PWM_MAIN_BASE, PWM_MAIN_OUTBIT, false);
+}
+
+/*********************************************************
+ * M1PWM5 (J3-10, PF1) is used for the tail rotor motor
+ *********************************************************/
+void
+halPWMTailInit (void)
+{
+    // As a precaution, make sure that the peripherals used are reset
+    SysCtlPeripheralReset (PWM_TAIL_PERIPH_GPIO);
+    SysCtlPeripheralReset (PWM_TAIL_PERIPH_PWM);
+
+    SysCtlPeripheralEnable (PWM_TAIL_PERIPH_PWM);
+    SysCtlPeripheralEnable (PWM_TAIL_PERIPH_GPIO);
+
+    GPIOPinConfigure (PWM_TAIL_GPIO_CONFIG);
+    GPIOPinTypePWM (PWM_TAIL_GPIO_BASE, PWM_TAIL_GPIO_PIN);
+
+    PWMGenConfigure (PWM_TAIL_BASE, PWM_TAIL_GEN,
+                    PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_NO_SYNC);
+
+    PWMGenEnable (PWM_TAIL_BASE, PWM_TAIL_GEN);
+
+    // Disable the output.  Repeat this call with 'true' to turn O/P on.
+    PWMOutputState (PWM_TAIL_BASE, PWM_TAIL_OUTBIT, false);
+}
+
+void
+halPWMMainSet (uint32_t period, uint32_t pulse_width)
+{
+    PWMGenPeriodSet (PWM_MAIN_BASE, PWM_MAIN_GEN, period);
+    PWMPulseWidthSet (PWM_MAIN_BASE, PWM_MAIN_OUTNUM, pulse_width);
+}
+
+void
+halPWMTailSet (uint32_t period, uint32_t pulse_width)
+{
+    PWMGenPeriodSet (PWM_TAIL_BASE, PWM_TAIL_GEN, period);
+    PWMPulseWidthSet (PWM_TAIL_BASE, PWM_TAIL_OUTNUM, pulse_width);
+}
+
+void
+halPWMMainEnable (bool enable)
+{
+    PWMOutputState (PWM_MAIN_BASE, PWM_MAIN_OUTBIT, enable);
+}
+
+void
+halPWMTailEnable (bool enable)
+{
+    PWMOutputState (PWM_TAIL_BASE, PWM_TAIL_OUTBIT, enable);
+}
+
+//*****************************************************************************
+// Intialise Timer0A as a periodic timer, with the load in system clock cycles
+//*****************************************************************************
+void
+halControlTimerInit (uint32_t load, hal_handler_t handler)
+{
+    // The Timer0 peripheral must be enabled for use.
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_TIMER0);
+
+    // Configure Timer0 as a 32-bit periodic timer.
+    TimerConfigure (TIMER0_BASE, TIMER_CFG_PERIODIC);
+
+    // Set timer value
+    TimerLoadSet (TIMER0_BASE, TIMER_A, load);
+
+    // Register interrupt
+    TimerIntRegister (TIMER0_BASE, TIMER_A, handler);
+
+    // Configure the Timer0A interrupt for timer timeout.
+    TimerIntEnable (TIMER0_BASE, TIMER_TIMA_TIMEOUT);
+
+    // Enable timer
+    TimerEnable (TIMER0_BASE, TIMER_A);
+}
+
+void
+halControlTimerIntClear (void)
+{
+    TimerIntClear (TIMER0_BASE, TIMER_TIMA_TIMEOUT);
+}
+
+//**********************************************************************
+// Initialise UART
+// Sourced from:  P.J. Bones  UCECE
+//**********************************************************************
+void
+halUARTInit (uint32_t baud)
+{
+    //
+    // Enable GPIO port A which is used for UART0 pins.
+    //
+    SysCtlPeripheralEnable (UART_USB_PERIPH_UART);
+    SysCtlPeripheralEnable (UART_USB_PERIPH_GPIO);
+    //
+    // Select the alternate (UART) function for these pins.
+    //
+    GPIOPinTypeUART (UART_USB_GPIO_BASE, UART_USB_GPIO_PINS);
+    GPIOPinConfigure (GPIO_PA0_U0RX);
+    GPIOPinConfigure (GPIO_PA1_U0TX);
+
+    UARTConfigSetExpClk (UART_USB_BASE, SysCtlClockGet(), baud,
+            UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+            UART_CONFIG_PAR_NONE);
+    UARTFIFOEnable (UART_USB_BASE);
+    UARTEnable (UART_USB_BASE);
+}
+
+void
+halUARTCharPut (char c)
+{
+    // Write the next character to the UART Tx FIFO, waiting for space
+    UARTCharPut (UART_USB_BASE, c);
+}
+
+//**********************************************************************
+// Transmit interrupt when the Tx FIFO falls to 4 of 16 characters
+//**********************************************************************
+void
+halUARTTxIntInit (hal_handler_t handler)
+{
+    UARTFIFOLevelSet (UART_USB_BASE, UART_FIFO_TX2_8, UART_FIFO_RX4_8);
+    UARTTxIntModeSet (UART_USB_BASE, UART_TXINT_MODE_FIFO);
+    UARTIntRegister (UART_USB_BASE, handler);
+}
+
+void
+halUARTTxIntEnable (bool enable)
+{
+    if (enable)
+        UARTIntEnable (UART_USB_BASE, UART_INT_TX);
+    else
+        UARTIntDisable (UART_USB_BASE, UART_INT_TX);
+}
+
+void
+halUARTTxIntClear (void)
+{
+    UARTIntClear (UART_USB_BASE, UART_INT_TX);
+}
+
+bool
+halUARTCharPutNonBlocking (char c)
+{
+    return UARTCharPutNonBlocking (UART_USB_BASE, c);
+}
+
+int32_t
+halUARTCharGetNonBlocking (void)
+{
+    return UARTCharGetNonBlocking (UART_USB_BASE);
+}
+
+//*****************************************************************************
+// Orbit OLED display
+// Code Sourced from:  P.J. Bones  UCECE
+//*****************************************************************************
+void
+halDisplayInit (void)
+{
+    OLEDInitialise ();
+}
+
+void
+halDisplayString (char *str, uint32_t col, uint32_t row)
+{
+    OLEDStringDraw (str, col, row);
+}
+
+//*****************************************************************************
+// On-chip EEPROM
+//*****************************************************************************
+bool
+halEEPROMInit (void)
+{
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_EEPROM0);
+    while (!SysCtlPeripheralReady (SYSCTL_PERIPH_EEPROM0))
+        continue;
+
+    // Recovers from a write interrupted by a reset
+    return EEPROMInit () == EEPROM_INIT_OK;
+}
+
+bool
+halEEPROMRead (uint32_t address, uint32_t *data, uint32_t words)
+{
+    if (address + words * 4 > EEPROMSizeGet ())
+        return false;
+
+    EEPROMRead (data, address, words * 4);
+    return true;
+}
+
+bool
+halEEPROMWrite (uint32_t address, const uint32_t *data, uint32_t words)
+{
+    if (address + words * 4 > EEPROMSizeGet ())
+        return false;
+
+    return EEPROMProgram ((uint32_t *) data, address, words * 4) == 0;
+}
+
+#endif /* HAL_HOST */
@@ -0,0 +1,127 @@
+#ifndef HANDOFF_H_
+#define HANDOFF_H_
+
+// *******************************************************
+// handoff.h
+//
+// Lock free passing of structures between the main loop and an interrupt
+// handler, without masking interrupts.
+//
+// Main loop to interrupt: a double buffer. The main loop fills the back
+// slot and publishes it by flipping the front index; the interrupt reads
+// the front slot. As the main loop never runs while the interrupt does,
+// the slot the interrupt is reading cannot change under it, and the slot
+// being written is never the one it reads.
+//
+// Interrupt to main loop: a sequence lock. The interrupt bumps the
+// sequence to odd, writes the value and bumps it to even; the main loop
+// copies the value and retries if the sequence changed meanwhile. The
+// writer is never preempted by the reader, so it never waits.
+//
+// Only compiler ordering is needed on the single core, which
+// atomic_signal_fence provides. Functions are inline as they are used in
+// the 2 kHz control interrupt.
+//
+// Defining HANDOFF_PREEMPT(), before this header is included, copies byte
+// by byte and calls it between bytes, so a test can run the other side at
+// every point (tools/handoffStress.c).
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef struct {
+    volatile uint8_t front;     // Slot the reader uses, 0 or 1
+} double_buffer_s;
+
+typedef struct {
+    volatile uint32_t sequence; // Odd while a write is in progress
+} seqlock_s;
+
+//*****************************************************************************
+// Copy a shared value, with preemption points when testing
+//*****************************************************************************
+static inline void
+handoffCopy (void *dest, const void *src, size_t size)
+{
+#ifdef HANDOFF_PREEMPT
+    uint8_t *d = dest;
+    const uint8_t *s = src;
+
+    while (size--) {
+        HANDOFF_PREEMPT ();
+        *d++ = *s++;
+    }
+    HANDOFF_PREEMPT ();
+#else
+    memcpy (dest, src, size);
+#endif
+}
+
+//*****************************************************************************
+// Double buffer, written by the main loop: copy value into the back slot
+// of slots[2] and make it the front
+//*****************************************************************************
+static inline void
+doubleBufferPublish (double_buffer_s *buffer, void *slots, const void *value, size_t size)
+{
+    uint8_t back = buffer->front ^ 1;
+
+    handoffCopy ((uint8_t *) slots + back * size, value, size);
+    atomic_signal_fence (memory_order_seq_cst);
+    buffer->front = back;
+}
+
+//*****************************************************************************
+// Double buffer, read by the interrupt: the front slot of slots[2], which
+// stays valid until the handler returns
+//*****************************************************************************
+static inline const void *
+doubleBufferFront (const double_buffer_s *buffer, const void *slots, size_t size)
+{
+    uint8_t front = buffer->front;
+
+    atomic_signal_fence (memory_order_seq_cst);
+    return (const uint8_t *) slots + front * size;
+}
+
+//*****************************************************************************
+// Sequence lock, written by the interrupt
+//*****************************************************************************
+static inline void
+seqlockWrite (seqlock_s *lock, void *shared, const void *value, size_t size)
+{
+    lock->sequence++;
+    atomic_signal_fence (memory_order_seq_cst);
+    handoffCopy (shared, value, size);
+    atomic_signal_fence (memory_order_seq_cst);
+    lock->sequence++;
+}
+
+//*****************************************************************************
+// Sequence lock, read by the main loop: copy out a consistent value
+//*****************************************************************************
+static inline void
+seqlockRead (const seqlock_s *lock, void *value, const void *shared, size_t size)
+{
+    uint32_t sequence;
+
+    do {
+        sequence = lock->sequence;
+        atomic_signal_fence (memory_order_seq_cst);
+        handoffCopy (value, shared, size);
+        atomic_signal_fence (memory_order_seq_cst);
+    } while ((sequence & 1) || sequence != lock->sequence);
+}
+
+#endif /* HANDOFF_H_ */
@@ -0,0 +1,198 @@
+//*****************************************************************************
+//
+// heightEstimator.c
+//
+// Kalman filter for height, velocity and model error from the ADC values
+// and the main duty. The state and covariance are float, as the filter
+// runs at the control rate in the main loop.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "heightEstimator.h"
+#include "altitude.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define HEIGHT_EST_STATES       3
+
+// ADC counts over the height range, as in calculate_percent_height
+#define HEIGHT_EST_RANGE_ADC    (0.8f / 3.33f * ADC_BITS)
+
+// Starting uncertainty, at rest on the base (standard deviations)
+#define HEIGHT_EST_START_HEIGHT 1.0f
+#define HEIGHT_EST_START_BIAS   50.0f
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+static height_estimate_s estimate;
+static float covariance[HEIGHT_EST_STATES][HEIGHT_EST_STATES];
+static float rotor;                     // Modelled main rotor speed, as duty (%)
+static float dt;                        // Update period (s)
+static float landed;                    // ADC reading at the bottom of the range
+static height_totals_s last_totals;     // Totals at the last update
+
+//*****************************************************************************
+// Start from rest on the base
+//*****************************************************************************
+void
+heightEstimatorInit (int32_t landed_adc, uint32_t period)
+{
+    uint32_t i;
+    uint32_t j;
+
+    landed = landed_adc;
+    dt = period / 1000.0f;
+    rotor = 0;
+    estimate.height = 0;
+    estimate.velocity = 0;
+    estimate.bias = 0;
+
+    for (i = 0; i < HEIGHT_EST_STATES; i++)
+        for (j = 0; j < HEIGHT_EST_STATES; j++)
+            covariance[i][j] = 0;
+    covariance[0][0] = HEIGHT_EST_START_HEIGHT * HEIGHT_EST_START_HEIGHT;
+    covariance[2][2] = HEIGHT_EST_START_BIAS * HEIGHT_EST_START_BIAS;
+
+    last_totals = getHeightTotals ();
+}
+
+//*****************************************************************************
+// Predict one period ahead through the rig model
+//*****************************************************************************
+static void
+heightPredict (uint32_t duty_main, uint32_t hover_duty)
+{
+    float lift;
+    float accel;
+    float transition[HEIGHT_EST_STATES][HEIGHT_EST_STATES];
+    float noise[HEIGHT_EST_STATES];     // Acceleration noise into each state
+    float product[HEIGHT_EST_STATES][HEIGHT_EST_STATES];
+    float sum;
+    uint32_t i;
+    uint32_t j;
+    uint32_t k;
+
+    // Main rotor speed lags its duty; lift goes with its square
+    rotor += (duty_main - rotor) * dt * 1000 / HEIGHT_EST_ROTOR_MS;
+    lift = hover_duty ? rotor / hover_duty : 0;
+    accel = HEIGHT_EST_GRAVITY * (lift * lift - 1) - HEIGHT_EST_DAMPING * estimate.velocity
+            + estimate.bias;
+
+    // The base and the top of the rig's travel stop it
+    if ((estimate.height <= 0 && accel < 0) || (estimate.height >= 100 && accel > 0)) {
+        accel = 0;
+        estimate.velocity = 0;
+    }
+
+    estimate.height += estimate.velocity * dt + accel * dt * dt / 2;
+    estimate.velocity += accel * dt;
+
+    // Covariance through the same step: P = F P F' + Q
+    transition[0][0] = 1;
+    transition[0][1] = dt - HEIGHT_EST_DAMPING * dt * dt / 2;
+    transition[0][2] = dt * dt / 2;
+    transition[1][0] = 0;
+    transition[1][1] = 1 - HEIGHT_EST_DAMPING * dt;
+    transition[1][2] = dt;
+    transition[2][0] = 0;
+    transition[2][1] = 0;
+    transition[2][2] = 1;
+
+    for (i = 0; i < HEIGHT_EST_STATES; i++)
+        for (j = 0; j < HEIGHT_EST_STATES; j++) {
+            for (sum = 0, k = 0; k < HEIGHT_EST_STATES; k++)
+                sum += transition[i][k] * covariance[k][j];
+            product[i][j] = sum;
+        }
+
+    noise[0] = HEIGHT_EST_ACCEL_NOISE * dt * dt / 2;
+    noise[1] = HEIGHT_EST_ACCEL_NOISE * dt;
+    noise[2] = 0;
+
+    for (i = 0; i < HEIGHT_EST_STATES; i++)
+        for (j = 0; j < HEIGHT_EST_STATES; j++) {
+            for (sum = 0, k = 0; k < HEIGHT_EST_STATES; k++)
+                sum += product[i][k] * transition[j][k];
+            covariance[i][j] = sum + noise[i] * noise[j];
+        }
+    covariance[2][2] += HEIGHT_EST_BIAS_DRIFT * HEIGHT_EST_BIAS_DRIFT * dt;
+}
+
+//*****************************************************************************
+// Correct the estimate with the mean of count ADC values. Taken evenly
+// over the period, their mean is the height half a period ago, so it is
+// compared with the height less half a period's climb.
+//*****************************************************************************
+static void
+heightCorrect (uint32_t sum, uint32_t count)
+{
+    float measured;
+    float variance;
+    float innovation;
+    float observe[HEIGHT_EST_STATES] = { 1, -dt / 2, 0 };
+    float gain[HEIGHT_EST_STATES];
+    float row[HEIGHT_EST_STATES];       // Observation times covariance
+    uint32_t i;
+    uint32_t j;
+
+    measured = 100 * (landed - (float) sum / count) / HEIGHT_EST_RANGE_ADC;
+    innovation = measured - (estimate.height - estimate.velocity * dt / 2);
+
+    for (i = 0; i < HEIGHT_EST_STATES; i++)
+        row[i] = observe[0] * covariance[0][i] + observe[1] * covariance[1][i];
+    variance = row[0] * observe[0] + row[1] * observe[1]
+               + HEIGHT_EST_ADC_NOISE * HEIGHT_EST_ADC_NOISE / count;
+
+    // The covariance is symmetric, so the gain is the row over the variance
+    for (i = 0; i < HEIGHT_EST_STATES; i++)
+        gain[i] = row[i] / variance;
+
+    estimate.height += gain[0] * innovation;
+    estimate.velocity += gain[1] * innovation;
+    estimate.bias += gain[2] * innovation;
+
+    for (i = 0; i < HEIGHT_EST_STATES; i++)
+        for (j = 0; j < HEIGHT_EST_STATES; j++)
+            covariance[i][j] -= gain[i] * row[j];
+}
+
+//*****************************************************************************
+// One update
+//*****************************************************************************
+void
+heightEstimatorUpdate (uint32_t duty_main, uint32_t hover_duty)
+{
+    height_totals_s totals = getHeightTotals ();
+
+    heightPredict (duty_main, hover_duty);
+
+    // Values since the last update, if any arrived
+    if (totals.count != last_totals.count)
+        heightCorrect (totals.sum - last_totals.sum, totals.count - last_totals.count);
+    last_totals = totals;
+}
+
+//*****************************************************************************
+// Pass the estimate out of module
+//*****************************************************************************
+height_estimate_s
+heightEstimate (void)
+{
+    return estimate;
+}
+
+//*****************************************************************************
+// The estimated height rounded to whole percent
+//*****************************************************************************
+int16_t
+heightEstimatePercent (void)
+{
+    return estimate.height >= 0 ? (int16_t) (estimate.height + 0.5f)
+                                : (int16_t) (estimate.height - 0.5f);
+}
@@ -0,0 +1,82 @@
+#ifndef HEIGHTESTIMATOR_H_
+#define HEIGHTESTIMATOR_H_
+
+// *******************************************************
+// heightEstimator.h
+//
+// Kalman filter for the helicopter's height, built in with
+// -DHEIGHT_ESTIMATOR in place of the moving average. Each control update
+// predicts the height and vertical velocity from the main duty last
+// applied, through a model of the rig:
+//
+//   rotor' = (duty - rotor) / tau
+//   accel  = g ((rotor / hover)^2 - 1) - d velocity + bias
+//
+// then corrects the prediction with the mean of every ADC value taken
+// since the last update, weighted by how many there were. The bias state
+// takes up what the model gets wrong, such as the hover duty before it is
+// found. The model stops at the ends of the range as the rig does.
+//
+// Unlike the moving average there is no window to wait out, and the
+// height keeps the resolution of the ADC until it is rounded for the
+// controllers. The velocity is there for anything that needs a rate of
+// climb. Everything runs in the main loop; the ADC interrupts only keep
+// running totals (getHeightTotals).
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+// Rig model, to fit to the rig
+#define HEIGHT_EST_GRAVITY      200.0f  // Net weight with the rotor stopped (%/s^2)
+#define HEIGHT_EST_DAMPING      3.0f    // Vertical damping (1/s)
+#define HEIGHT_EST_ROTOR_MS     250     // Main rotor speed lag behind its duty
+
+// Noise, setting how far the model is trusted over the ADC
+#define HEIGHT_EST_ADC_NOISE    0.35f   // Each ADC value (% of range, standard deviation)
+#define HEIGHT_EST_ACCEL_NOISE  30.0f   // Unmodelled acceleration (%/s^2)
+#define HEIGHT_EST_BIAS_DRIFT   20.0f   // Change in the model's error (%/s^2 per root second)
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef struct {
+    float height;               // % of range
+    float velocity;             // % of range per second, up positive
+    float bias;                 // Acceleration the model is missing (%/s^2)
+} height_estimate_s;
+
+//*****************************************************************************
+// Start from rest on the base, given the landed ADC reading, with
+// heightEstimatorUpdate called every period ms
+//*****************************************************************************
+void
+heightEstimatorInit (int32_t landed_adc, uint32_t period);
+
+//*****************************************************************************
+// One update, from the main duty applied since the last one and the hover
+// duty (%)
+//*****************************************************************************
+void
+heightEstimatorUpdate (uint32_t duty_main, uint32_t hover_duty);
+
+//*****************************************************************************
+// Pass the estimate out of module
+//*****************************************************************************
+height_estimate_s
+heightEstimate (void);
+
+//*****************************************************************************
+// The estimated height rounded to whole percent, for the controllers
+//*****************************************************************************
+int16_t
+heightEstimatePercent (void);
+
+#endif /* HEIGHTESTIMATOR_H_ */
@@ -0,0 +1,208 @@
+//*****************************************************************************
+//
+// isrLatency.c
+//
+// Latency and duration histograms for the interrupt handlers, with log2
+// buckets so a few hundred bytes of RAM cover 1 cycle to over 16000.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "isrLatency.h"
+#include "hal.h"
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef struct {
+    uint32_t runs;
+    uint32_t min;
+    uint32_t max;
+    uint32_t buckets[LATENCY_BUCKETS];
+} histogram_s;
+
+typedef struct {
+    histogram_s latency;
+    histogram_s duration;
+    uint32_t resets;            // Value of latency_resets when last cleared
+} latency_s;
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+static latency_s latency_table[HAL_INT_COUNT];
+static volatile uint32_t latency_resets;    // Incremented to request a clear
+static uint32_t overhead;                   // Cost of an empty measurement
+
+static const char *latency_names[HAL_INT_COUNT] = {
+    "SysTickIntHandler",
+    "responseControlIntHandler",
+    "ADCIntHandler",
+    "GPIOPinIntHandler",
+};
+
+//*****************************************************************************
+// Bucket for a value: the number of significant bits, capped
+//*****************************************************************************
+static uint32_t
+latencyBucket (uint32_t value)
+{
+    uint32_t bucket = 0;
+
+    while (value && bucket < LATENCY_BUCKETS - 1) {
+        value >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+static void
+histogramAdd (histogram_s *h, uint32_t value)
+{
+    if (value < h->min)
+        h->min = value;
+    if (value > h->max)
+        h->max = value;
+    h->buckets[latencyBucket (value)]++;
+    h->runs++;
+}
+
+static void
+histogramClear (histogram_s *h)
+{
+    memset (h, 0, sizeof (*h));
+    h->min = UINT32_MAX;
+}
+
+//*****************************************************************************
+// Start the cycle counter, measure the marker overhead and clear the results
+//*****************************************************************************
+void
+isrLatencyInit (void)
+{
+    uint32_t start;
+    uint32_t cycles;
+    int i;
+
+    halCycleCounterInit ();
+
+    // Take the smallest of several empty measurements as the overhead
+    overhead = UINT32_MAX;
+    for (i = 0; i < 16; i++) {
+        start = halCycleCount ();
+        cycles = halCycleCount () - start;
+        if (cycles < overhead)
+            overhead = cycles;
+    }
+
+    for (i = 0; i < HAL_INT_COUNT; i++) {
+        histogramClear (&latency_table[i].latency);
+        histogramClear (&latency_table[i].duration);
+        latency_table[i].resets = latency_resets;
+    }
+}
+
+//*****************************************************************************
+// Add one handler run
+//*****************************************************************************
+void
+isrLatencyRecord (hal_int_t source, uint32_t latency, uint32_t duration)
+{
+    latency_s *l = &latency_table[source];
+
+    // Carry out a clear requested since the last run
+    if (l->resets != latency_resets) {
+        l->resets = latency_resets;
+        histogramClear (&l->latency);
+        histogramClear (&l->duration);
+    }
+
+    if (latency != HAL_LATENCY_UNKNOWN)
+        histogramAdd (&l->latency, latency);
+    histogramAdd (&l->duration, duration > overhead ? duration - overhead : 0);
+}
+
+//*****************************************************************************
+// Clear the results
+//*****************************************************************************
+void
+isrLatencyReset (void)
+{
+    latency_resets++;
+}
+
+//*****************************************************************************
+// One histogram as a CSV line. Counts may be one run apart, as the handlers
+// keep recording while they are sent.
+//*****************************************************************************
+static uint32_t
+histogramLine (char *line, const char *name, const char *kind, const histogram_s *h,
+               bool cleared)
+{
+    int length;
+    int i;
+
+    if (cleared || h->runs == 0) {
+        length = usprintf (line, "%s,%s,0,0,0", name, kind);
+        for (i = 0; i < LATENCY_BUCKETS; i++)
+            length += usprintf (line + length, ",0");
+    } else {
+        length = usprintf (line, "%s,%s,%u,%u,%u", name, kind, h->runs, h->min, h->max);
+        for (i = 0; i < LATENCY_BUCKETS; i++)
+            length += usprintf (line + length, ",%u", h->buckets[i]);
+    }
+    return length + usprintf (line + length, "\r\n");
+}
+
+//*****************************************************************************
+// One line of the report
+//*****************************************************************************
+uint32_t
+isrLatencyReportLine (uint32_t index, char *line)
+{
+    const latency_s *l;
+    int length;
+    bool cleared;
+    int i;
+
+    if (index == 0)
+        return usprintf (line, "latency,unit_hz=%u,overhead=%u\r\n", halCycleRate (), overhead);
+
+    if (index == 1) {
+        // Bucket n counts values below 2^n, the last the rest
+        length = usprintf (line, "handler,kind,runs,min,max");
+        for (i = 0; i < LATENCY_BUCKETS - 1; i++)
+            length += usprintf (line + length, ",lt%u", 1u << i);
+        return length + usprintf (line + length, ",ge%u\r\n", 1u << (LATENCY_BUCKETS - 2));
+    }
+
+    // Then latency and duration for each handler
+    index -= 2;
+    if (index >= 2 * HAL_INT_COUNT)
+        return 0;
+
+    // A handler that has not run since a clear still holds old counts
+    l = &latency_table[index / 2];
+    cleared = l->resets != latency_resets;
+    if (index % 2 == 0)
+        return histogramLine (line, latency_names[index / 2], "latency", &l->latency, cleared);
+    return histogramLine (line, latency_names[index / 2], "duration", &l->duration, cleared);
+}
+
+//*****************************************************************************
+// Send the whole report
+//*****************************************************************************
+void
+isrLatencyReport (void (*send)(char *line))
+{
+    char line[LATENCY_LINE_LEN];
+    uint32_t index = 0;
+
+    while (isrLatencyReportLine (index++, line))
+        send (line);
+}
@@ -0,0 +1,80 @@
+#ifndef ISRLATENCY_H_
+#define ISRLATENCY_H_
+
+// *******************************************************
+// isrLatency.h
+//
+// Latency and duration histograms for the interrupt handlers. On entry a
+// handler reads how long ago its interrupt was raised (halIntLatency) and
+// the cycle counter; on exit the two are added to log2 bucket histograms.
+// Built in when ISR_LATENCY is defined; otherwise the markers compile to
+// nothing. The histograms are sent over the UART, and cleared, on command
+// from the host (LATENCY_CMD_REPORT and LATENCY_CMD_RESET).
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define LATENCY_BUCKETS     16      // Bucket 0 holds 0, bucket n holds 2^(n-1)
+                                    // to 2^n - 1, the last everything above
+#define LATENCY_CMD_REPORT  'h'     // UART command to send the histograms
+#define LATENCY_CMD_RESET   'c'     // UART command to clear them
+#define LATENCY_LINE_LEN    256     // Longest report line, with its terminator
+
+//*****************************************************************************
+// Markers placed at the very start and end of a handler
+//*****************************************************************************
+#ifdef ISR_LATENCY
+#define LATENCY_ENTER(source)   uint32_t latency_delay = halIntLatency (source); \
+                                uint32_t latency_entry = halCycleCount ()
+#define LATENCY_EXIT(source)    isrLatencyRecord ((source), latency_delay, \
+                                                  halCycleCount () - latency_entry)
+#else
+#define LATENCY_ENTER(source)
+#define LATENCY_EXIT(source)
+#endif
+
+//*****************************************************************************
+// Start the cycle counter, measure the marker overhead and clear the results
+//*****************************************************************************
+void
+isrLatencyInit (void);
+
+//*****************************************************************************
+// Add one handler run. A latency of HAL_LATENCY_UNKNOWN is not recorded.
+//*****************************************************************************
+void
+isrLatencyRecord (hal_int_t source, uint32_t latency, uint32_t duration);
+
+//*****************************************************************************
+// Clear the results. Each handler's histograms are cleared on its next run,
+// so the main loop never writes them under an interrupt.
+//*****************************************************************************
+void
+isrLatencyReset (void);
+
+//*****************************************************************************
+// Line index of the histogram report into line, returning its length, or 0
+// past the last line. The report is a header line, the column names, then
+// CSV lines of handler, latency or duration, runs recorded, min, max and
+// the count in each bucket. The firmware sends it a line at a time as the
+// UART has room.
+//*****************************************************************************
+uint32_t
+isrLatencyReportLine (uint32_t index, char *line);
+
+//*****************************************************************************
+// Send the whole report at once, a line per call of send
+//*****************************************************************************
+void
+isrLatencyReport (void (*send)(char *line));
+
+#endif /* ISRLATENCY_H_ */
@@ -0,0 +1,144 @@
+//*****************************************************************************
+//
+// isrProfile.c
+//
+// Per-call execution time measurement for the interrupt handlers and the
+// hot functions they call, with a worst case CPU budget table.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "isrProfile.h"
+#include "system.h"
+#include "responseControl.h"
+#include "altitude.h"
+#include "hal.h"
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef struct {
+    uint32_t calls;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} profile_s;
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+static profile_s profile[PROFILE_COUNT];
+static uint32_t overhead;                   // Cost of an empty measurement
+
+static const char *profile_names[PROFILE_COUNT] = {
+    "ADCIntHandler",
+    "GPIOPinIntHandler",
+    "responseControlIntHandler",
+    "calculateYaw",
+    "getHeight",
+};
+
+static const uint32_t profile_rates[PROFILE_COUNT] = {
+#if defined(ADC_DMA)
+    ADC_DMA_RATE_HZ / ADC_DMA_BLOCK,
+#elif defined(ADC_TIMER)
+    ADC_TIMER_RATE_HZ,
+#else
+    SAMPLE_RATE_HZ,
+#endif
+    PROFILE_EDGE_RATE_HZ,
+    TIMER_RATE,
+    PROFILE_EDGE_RATE_HZ,
+    PROFILE_MAIN_RATE_HZ,
+};
+
+//*****************************************************************************
+// Start the cycle counter, measure the marker overhead and clear the results
+//*****************************************************************************
+void
+isrProfileInit (void)
+{
+    uint32_t start;
+    uint32_t cycles;
+    int i;
+
+    halCycleCounterInit ();
+
+    // Take the smallest of several empty measurements as the overhead
+    overhead = UINT32_MAX;
+    for (i = 0; i < 16; i++) {
+        start = halCycleCount ();
+        cycles = halCycleCount () - start;
+        if (cycles < overhead)
+            overhead = cycles;
+    }
+
+    isrProfileReset ();
+}
+
+//*****************************************************************************
+// Add one measurement
+//*****************************************************************************
+void
+isrProfileRecord (profile_id id, uint32_t cycles)
+{
+    profile_s *p = &profile[id];
+
+    cycles = (cycles > overhead) ? cycles - overhead : 0;
+
+    if (cycles < p->min)
+        p->min = cycles;
+    if (cycles > p->max)
+        p->max = cycles;
+    p->total += cycles;
+    p->calls++;
+}
+
+//*****************************************************************************
+// Clear the results
+//*****************************************************************************
+void
+isrProfileReset (void)
+{
+    int i;
+
+    for (i = 0; i < PROFILE_COUNT; i++) {
+        profile[i].calls = 0;
+        profile[i].min = UINT32_MAX;
+        profile[i].max = 0;
+        profile[i].total = 0;
+    }
+}
+
+//*****************************************************************************
+// Send the results as CSV lines
+//*****************************************************************************
+void
+isrProfileReport (void (*send)(char *line))
+{
+    char line[96];
+    uint32_t mean;
+    uint32_t budget;    // Hundredths of a percent
+    int i;
+
+    usprintf (line, "profile,unit_hz=%u,overhead=%u\r\n", halCycleRate (), overhead);
+    send (line);
+    send ("name,calls,min,mean,max,rate_hz,budget_pct\r\n");
+
+    for (i = 0; i < PROFILE_COUNT; i++) {
+        profile_s *p = &profile[i];
+
+        if (p->calls == 0) {
+            usprintf (line, "%s,0,0,0,0,%u,0.00\r\n", profile_names[i], profile_rates[i]);
+        } else {
+            mean = p->total / p->calls;
+            budget = (uint64_t) p->max * profile_rates[i] * 10000 / halCycleRate ();
+            usprintf (line, "%s,%u,%u,%u,%u,%u,%u.%02u\r\n", profile_names[i], p->calls,
+                      p->min, mean, p->max, profile_rates[i], budget / 100, budget % 100);
+        }
+        send (line);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef ISRPROFILE_H_
+#define ISRPROFILE_H_
+
+// *******************************************************
+// isrProfile.h
+//
+// Per-call execution time measurement for the interrupt handlers and the
+// hot functions they call. Built in when ISR_PROFILE is defined; otherwise
+// the markers compile to nothing. Counts come from the HAL cycle counter
+// (DWT CYCCNT on target, nanoseconds on the host simulator).
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define PROFILE_EDGE_RATE_HZ    2000    // Worst case encoder edge rate (4.5 rev/s)
+#define PROFILE_MAIN_RATE_HZ    50      // Main loop rate
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef enum {
+    PROFILE_ADC_INT,
+    PROFILE_GPIO_PIN_INT,
+    PROFILE_RESPONSE_CONTROL_INT,
+    PROFILE_CALCULATE_YAW,
+    PROFILE_GET_HEIGHT,
+    PROFILE_COUNT
+} profile_id;
+
+//*****************************************************************************
+// Markers placed at the start and end of a measured function
+//*****************************************************************************
+#ifdef ISR_PROFILE
+#define PROFILE_START()     uint32_t profile_start = halCycleCount ()
+#define PROFILE_STOP(id)    isrProfileRecord ((id), halCycleCount () - profile_start)
+#else
+#define PROFILE_START()
+#define PROFILE_STOP(id)
+#endif
+
+//*****************************************************************************
+// Start the cycle counter, measure the marker overhead and clear the results
+//*****************************************************************************
+void
+isrProfileInit (void);
+
+//*****************************************************************************
+// Add one measurement
+//*****************************************************************************
+void
+isrProfileRecord (profile_id id, uint32_t cycles);
+
+//*****************************************************************************
+// Clear the results
+//*****************************************************************************
+void
+isrProfileReset (void);
+
+//*****************************************************************************
+// Send the results as CSV lines: name, calls, min, mean and max counts, the
+// worst case rate and the CPU share (%) of the max cost at that rate
+//*****************************************************************************
+void
+isrProfileReport (void (*send)(char *line));
+
+#endif /* ISRPROFILE_H_ */
@@ -11,184 +11,504 @@
 // Helicopter state, position and dut cycle information is continuously updated
 // through both UART transmissions and via the OLED display.
 //
+// The work is split into tasks with their own rates, run by the rate
+// monotonic scheduler in scheduler.c.
+//
 // Authors: T.R. Peterson, M.G. Gardyne, M. Comber
-// Last modified: 19/5/2021
+// Last modified: 18/10/2026
 //
 
 #include <stdint.h>
 #include <stdbool.h>
-#include "driverlib/sysctl.h"
-#include "driverlib/interrupt.h"
+#include <stdlib.h>
 #include "buttons4.h"
 #include "yaw.h"
 #include "altitude.h"
+#include "heightEstimator.h"
 #include "display.h"
 #include "uart.h"
+#include "telemetry.h"
 #include "system.h"
 #include "flight_mode.h"
 #include "responseControl.h"
+#include "isrProfile.h"
+#include "isrLatency.h"
+#include "recorder.h"
+#include "calibration.h"
+#include "autotune.h"
+#include "scheduler.h"
+#include "hal.h"
 
 
-int
-main(void)
-{
-    flight_mode current_state;
-    height_data_s height_data;
-    yaw_data_s yaw_data;
-    duty_cycle_s heli_duty;
-    int32_t height_current_adc;
-    int32_t height_landed_adc;
-    uint32_t hover_height = 1;
-    uint8_t slowTick;
-    bool ref_yaw_found = false;
-    bool hover_duty_found = false;
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define BUTTONS_PERIOD_MS   10      // Button polling and setpoint changes
+#define STATE_PERIOD_MS     20      // Flight state machine
+#define CONTROL_PERIOD_MS   20      // Height and yaw update for the controllers
+#define DISPLAY_PERIOD_MS   (1000 / DISPLAY_MAX_RATE_HZ)   // OLED refresh
+#define COMMAND_PERIOD_MS   50      // Host commands, within the 16 character RX FIFO
+#define RECORDER_PERIOD_MS  20      // Flight recorder dump, as the UART has room
+#ifndef TELEMETRY_PERIOD_MS
+#ifdef TELEMETRY_BINARY
+#define TELEMETRY_PERIOD_MS 10      // Binary frames
+#else
+#define TELEMETRY_PERIOD_MS 100     // Text status messages
+#endif
+#endif
 
+// The link must carry the frames, with a quarter to spare for command
+// replies and reports
+#if defined(TELEMETRY_BINARY) && \
+    TELEMETRY_FRAME_LEN * UART_CHAR_BITS * 1000 / TELEMETRY_PERIOD_MS > BAUD_RATE * 3 / 4
+#error "BAUD_RATE is too low for telemetry frames every TELEMETRY_PERIOD_MS"
+#endif
 
-    // As a precaution, make sure that the peripherals used are reset
-    SysCtlPeripheralReset (LEFT_BUT_PERIPH);
-    SysCtlPeripheralReset (UP_BUT_PERIPH);
-    SysCtlPeripheralReset (SYSCTL_PERIPH_GPIOB);
-    SysCtlPeripheralReset (SYSCTL_PERIPH_GPIOC);
-    SysCtlPeripheralReset (UART_USB_PERIPH_UART);
-    SysCtlPeripheralReset (UART_USB_PERIPH_GPIO);
-    SysCtlPeripheralReset (SYSCTL_PERIPH_TIMER0);
+// Features taking commands from the host over the UART
+#if defined(ISR_LATENCY) || defined(FLIGHT_RECORDER) || defined(AUTOTUNE)
+#define HOST_COMMANDS
+#endif
 
-    // Initialise peripherals and modules
-    initClock ();
-    initAltitude ();
-    initYaw ();
-    initButtons ();
-    initDisplay ();
-    initUSB_UART ();
-    initSwitches ();
-    initSoftReset ();
+//*****************************************************************************
+// Global variables, shared by the tasks
+//*****************************************************************************
+static flight_mode current_state;
+static height_data_s height_data;
+static yaw_data_s yaw_data;
+static duty_cycle_s heli_duty;
+static int32_t height_landed_adc;
+static uint32_t hover_height = 1;
+static bool ref_yaw_found;
+static bool hover_duty_found;
+static calibration_s calibration;
+static bool calibration_pending;    // Store calibration once at rest after landing
+static bool yaw_seed_pending;       // Seed the heading when the first flight starts
+static int32_t rest_count;          // Yaw count while waiting to be at rest
+static uint32_t rest_ms;            // Time the yaw count has been unchanged
+static bool autotune_store;         // Store the gains autotune finds
+#ifdef ISR_PROFILE
+static bool profile_pending;        // Report costs once the rotors are off
+#endif
+#ifdef ISR_LATENCY
+static bool latency_reporting;      // Latency report being sent
+static uint32_t latency_line;       // Its next line
+#endif
 
-    // Enable interrupts to the processor.
-    IntMasterEnable();
+//*****************************************************************************
+// Task functions
+//*****************************************************************************
+static void taskButtons (void);
+static void taskState (void);
+static void taskControl (void);
+static void taskDisplay (void);
+static void taskTelemetry (void);
+#ifdef HOST_COMMANDS
+static void taskCommand (void);
+#endif
+#ifdef FLIGHT_RECORDER
+static void taskRecorder (void);
+#endif
 
-    // System delay for accurate initial value calibration
-    SysCtlDelay (SysCtlClockGet() / 60);
+static sched_task_s tasks[] = {
+    { .name = "buttons",   .run = taskButtons,   .period = SCHED_MS (BUTTONS_PERIOD_MS) },
+    { .name = "state",     .run = taskState,     .period = SCHED_MS (STATE_PERIOD_MS) },
+    { .name = "control",   .run = taskControl,   .period = SCHED_MS (CONTROL_PERIOD_MS) },
+    { .name = "display",   .run = taskDisplay,   .period = SCHED_MS (DISPLAY_PERIOD_MS) },
+    { .name = "telemetry", .run = taskTelemetry, .period = SCHED_MS (TELEMETRY_PERIOD_MS) },
+#ifdef HOST_COMMANDS
+    { .name = "command",   .run = taskCommand,   .period = SCHED_MS (COMMAND_PERIOD_MS) },
+#endif
+#ifdef FLIGHT_RECORDER
+    { .name = "recorder",  .run = taskRecorder,  .period = SCHED_MS (RECORDER_PERIOD_MS) },
+#endif
+};
 
-    // Set initial helicopter resting height
-    height_landed_adc = getHeight();
+//*****************************************************************************
+// Poll the buttons, and change the setpoints with them while flying
+//*****************************************************************************
+static void
+taskButtons (void)
+{
+    updateButtons();
 
-    // Intialise helicopter state
-    current_state = landed;
+    if (current_state != flying)
+        return;
 
-    while (1)
+    // Increase main rotor duty cycle if up button pressed
+    if (checkButton (UP) == PUSHED)
     {
-        // Pace program at apporx 50 Hz
-        SysCtlDelay (SysCtlClockGet() / 50);
-
-        // Update helicopter state
-        current_state = updateState(current_state);
+        // Limit max height to 100%
+        if (height_data.target < 90) {
+            height_data.target += 10;
+        } else {
+            height_data.target = 100;
+        }
+    }
 
-        // Helicopter functionality based on current state
-        switch (current_state)
-        {
-        case landed:
-            // Keep target values at home
-            height_data.target = 0;
-            yaw_data.target = 0;
-            break;
-        case landing:
-            // Set target values to home
+    // Decrease main rotor duty cycle if down button pressed
+    if (checkButton (DOWN) == PUSHED)
+    {
+        // Limit minimum height to 0%
+        if (height_data.target > 10) {
+            height_data.target -= 10;
+        } else {
             height_data.target = 0;
-            yaw_data.target = 0;
+        }
+    }
 
-            // Update helicopter state to landed when reference orientation reached
-            if (yaw_data.current == 0 && height_data.current <= 0) {
-                current_state = landed;
-            }
-            break;
-        case initialising:
-            // First find hover duty for the helicopter
-            if (!hover_duty_found) {
-                height_data.target = hover_height;
-                if (height_data.current == hover_height) {
-                    hover_duty_found = true;
-                    height_data.target = 0;
-                }
-
-            // Second find the refence yaw orientation
-            } else if (!ref_yaw_found) {
-                // Update the reference yaw value from yaw module
-                ref_yaw_found = findReference();
-
-            // Once complete set the mode to flying
-            } else {
-                current_state = flying;
-                height_data.target = 0;
+    // Decrease yaw if left button pushed
+    if ((checkButton (LEFT) == PUSHED))
+    {
+        // Keep yaw in 180 to -179 range
+        if (yaw_data.target == -165) {
+            yaw_data.target = 180;
+        } else {
+            yaw_data.target -= 15;
+        }
+    }
+
+    // Increase yaw if right button pushed
+    if ((checkButton (RIGHT) == PUSHED))
+    {
+        // Keep yaw in 180 to -179 range
+        if (yaw_data.target == 180) {
+            yaw_data.target = -165;
+        } else {
+            yaw_data.target += 15;
+        }
+    }
+}
+
+//*****************************************************************************
+// Update the flight state and the targets it sets
+//*****************************************************************************
+static void
+taskState (void)
+{
+    // Update helicopter state
+    current_state = updateState(current_state);
+
+    // Helicopter functionality based on current state
+    switch (current_state)
+    {
+    case landed:
+        // Keep target values at home
+        height_data.target = 0;
+        yaw_data.target = 0;
+
+#ifdef ISR_PROFILE
+        // Report interrupt and task costs at the end of a flight, once the
+        // control interrupt has stopped the rotors, as waiting for the link
+        // holds up the main loop
+        if (profile_pending && heli_duty.main == 0 && heli_duty.tail == 0) {
+            isrProfileReport (UARTSendWait);
+            isrProfileReset ();
+            schedulerReport (UARTSendWait);
+            profile_pending = false;
+        }
+#endif
+
+        // Store calibration for a warm start once the rotors have run down
+        // and the heading has stopped changing
+        if (calibration_pending) {
+            if (getYawCount () != rest_count) {
+                rest_count = getYawCount ();
+                rest_ms = 0;
+            } else if ((rest_ms += STATE_PERIOD_MS) >= CAL_REST_MS) {
+                calibration.hover_duty = getHoverDuty ();
+                calibration.yaw_rest = rest_count;
+                calibration.coupling = responseControlCoupling ();
+                calibration.flags |= CAL_FLAG_COUPLING;
+                calibrationSave (&calibration);
+                calibration_pending = false;
             }
-            break;
-        case flying:
-            // Increase main rotor duty cycle if up button pressed
-            if (checkButton (UP) == PUSHED)
-            {
-                // Limit max height to 100%
-                if (height_data.target < 90) {
-                    height_data.target += 10;
-                } else {
-                    height_data.target = 100;
-                }
+        }
+        break;
+    case landing:
+        // Set target values to home
+        height_data.target = 0;
+        yaw_data.target = 0;
+
+        // Update helicopter state to landed when reference orientation reached
+        if (yaw_data.current == 0 && height_data.current <= 0) {
+            current_state = landed;
+#ifdef ISR_PROFILE
+            profile_pending = ref_yaw_found;
+#endif
+#ifdef FLIGHT_RECORDER
+            // Send the flight's capture, or the landing if nothing triggered
+            if (ref_yaw_found)
+                recorderDump ();
+#endif
+            if (ref_yaw_found) {
+                calibration_pending = true;
+                rest_ms = 0;
             }
+        }
+        break;
+    case initialising:
+        // Seed the calibrated heading now rather than at power up, as the
+        // startup landing only ends at a heading of zero
+        if (yaw_seed_pending) {
+            yawWarmStart (calibration.yaw_rest);
+            yaw_seed_pending = false;
+        }
 
-            // Decrease main rotor duty cycle if down button pressed
-            if (checkButton (DOWN) == PUSHED)
-            {
-                // Limit minimum height to 0%
-                if (height_data.target > 10) {
-                    height_data.target -= 10;
-                } else {
-                    height_data.target = 0;
-                }
+        // First find hover duty for the helicopter
+        if (!hover_duty_found) {
+            height_data.target = hover_height;
+            if (height_data.current == hover_height) {
+                hover_duty_found = true;
+                height_data.target = 0;
             }
 
-            // Decrease yaw if left button pushed
-            if ((checkButton (LEFT) == PUSHED))
-            {
-                // Keep yaw in 180 to -179 range
-                if (yaw_data.target == -165) {
-                    yaw_data.target = 180;
-                } else {
-                    yaw_data.target -= 15;
-                }
+        // Second find the refence yaw orientation
+        } else if (!ref_yaw_found) {
+            // Hold a heading seeded from calibration at the approach point
+            if (yawApproaching())
+                yaw_data.target = YAW_APPROACH_DEG;
+
+            // Update the reference yaw value from yaw module
+            ref_yaw_found = findReference();
+
+        // Once complete set the mode to flying
+        } else {
+            current_state = flying;
+            height_data.target = 0;
+            yaw_data.target = 0;
+        }
+        break;
+    case flying:
+        // Setpoints are changed by the buttons task
+        break;
+    case autotuning:
+        // Setpoints are held while the relay experiments run, then the new
+        // gains are used from the next control step
+        if (autotunePhase () == AUTOTUNE_DONE) {
+            pi_gains_s gains;
+
+            autotuneGains (&gains);
+            responseControlSetGains (&gains);
+            if (autotune_store) {
+                // Stored with the rest of the calibration after landing
+                calibration.gains = gains;
+                calibration.flags |= CAL_FLAG_GAINS;
             }
+        }
+        if (autotunePhase () >= AUTOTUNE_DONE) {
+            autotuneReport (UARTSend);
+            current_state = flying;
+        }
+        break;
+    }
+}
+
+//*****************************************************************************
+// Measure height and yaw and pass them to the controllers
+//*****************************************************************************
+static void
+taskControl (void)
+{
+#if defined(HEIGHT_ESTIMATOR) || defined(HAL_HOST)
+    // Estimate the height from the ADC values since the last update and
+    // the main duty applied over them
+    heightEstimatorUpdate (getHeliDuty().main, getHoverDuty ());
+#endif
+
+#ifdef HEIGHT_ESTIMATOR
+    height_data.current = heightEstimatePercent ();
+#else
+    // Get current helicopter height and convert it to a percentage
+    height_data.current = calculate_percent_height(getHeight(), height_landed_adc);
+#endif
+
+    // Get current yaw and its rate from yaw module
+    yaw_data.current = getYawCurrent();
+    updateYawRate();
+    yaw_data.rate = getYawRate();
+
+    // Update response control
+    updateResponseControl(height_data, yaw_data);
 
-            // Increase yaw if right button pushed
-            if ((checkButton (RIGHT) == PUSHED))
-            {
-                // Keep yaw in 180 to -179 range
-                if (yaw_data.target == 180) {
-                    yaw_data.target = -165;
-                } else {
-                    yaw_data.target += 15;
-                }
+    // Update helicopter duty cycle values
+    heli_duty = getHeliDuty();
+}
+
+//*****************************************************************************
+// Display helicopter details
+//*****************************************************************************
+static void
+taskDisplay (void)
+{
+    displayData (height_data.current, yaw_data.current, heli_duty);
+}
+
+//*****************************************************************************
+// Carry out UART transmission of helicopter data
+//*****************************************************************************
+static void
+taskTelemetry (void)
+{
+#ifdef FLIGHT_RECORDER
+    // Leave the link to the recorder dump
+    if (recorderDumping ())
+        return;
+#endif
+
+    UARTTransData (height_data, yaw_data, heli_duty, current_state);
+}
+
+#ifdef HOST_COMMANDS
+//*****************************************************************************
+// Carry out commands received from the host
+//*****************************************************************************
+static void
+taskCommand (void)
+{
+    int32_t c;
+#ifdef ISR_LATENCY
+    char line[LATENCY_LINE_LEN];
+#endif
+
+    while ((c = UARTReceive ()) >= 0)
+    {
+        switch (c)
+        {
+#ifdef ISR_LATENCY
+        case LATENCY_CMD_REPORT:
+            latency_reporting = true;
+            latency_line = 0;
+            break;
+        case LATENCY_CMD_RESET:
+            isrLatencyReset ();
+            break;
+#endif
+#ifdef FLIGHT_RECORDER
+        case RECORDER_CMD_DUMP:
+            recorderDump ();
+            break;
+#endif
+#ifdef AUTOTUNE
+        case AUTOTUNE_CMD_START:
+        case AUTOTUNE_CMD_STORE:
+            // Only from a steady setpoint in flight
+            if (current_state == flying) {
+                autotune_store = c == AUTOTUNE_CMD_STORE;
+                autotuneStart (CONTROL_PERIOD_MS);
+                current_state = autotuning;
             }
+            break;
+#endif
         }
+    }
 
-        // Get current helicopter height
-        height_current_adc = getHeight();
+#ifdef ISR_LATENCY
+    // Send the latency report a line at a time while the UART has room for
+    // the longest one, so it is never dropped
+    while (latency_reporting && UARTTxSpace () >= LATENCY_LINE_LEN)
+    {
+        if (!isrLatencyReportLine (latency_line++, line)) {
+            latency_reporting = false;
+            break;
+        }
+        UARTSend (line);
+    }
+#endif
+}
+#endif
 
-        // Convert ADC height to percentage
-        height_data.current = calculate_percent_height(height_current_adc, height_landed_adc);
+#ifdef FLIGHT_RECORDER
+//*****************************************************************************
+// Send flight recorder frames while the UART has room for whole ones
+//*****************************************************************************
+static void
+taskRecorder (void)
+{
+    uint8_t frame[RECORDER_FRAME_LEN];
+    uint32_t length;
+
+    while (recorderDumping () && UARTTxSpace () >= RECORDER_FRAME_LEN)
+    {
+        length = recorderDumpFrame (frame);
+        if (length == 0)
+            break;
+        UARTSendBytes (frame, length);
+    }
+}
+#endif
 
-        // Get current yaw from yaw module
-        yaw_data.current = getYawCurrent();
+//*****************************************************************************
+// Firmware entry point. On the host the simulator owns main() and calls this.
+//*****************************************************************************
+#ifdef HAL_HOST
+int
+firmwareMain(void)
+#else
+int
+main(void)
+#endif
+{
+    // As a precaution, make sure that the peripherals used are reset
+    halPeripheralsReset ();
 
-        // Update response control
-        updateResponseControl(height_data, yaw_data);
+    // Initialise peripherals and modules
+    initClock ();
+#ifdef ISR_PROFILE
+    isrProfileInit ();
+#endif
+#ifdef ISR_LATENCY
+    isrLatencyInit ();
+#endif
+    initAltitude ();
+    initYaw ();
+    initButtons ();
+    initDisplay ();
+    initUSB_UART ();
+    initSwitches ();
+    initSoftReset ();
 
-        // Update helicopter duty cycle values
-        heli_duty = getHeliDuty();
+    // Enable interrupts to the processor.
+    halIntMasterEnable();
 
-        // Display helicopter details
-        displayData (height_data.current, yaw_data.current, heli_duty);
+    // System delay for accurate initial value calibration
+    halDelay (halClockGet() / 60);
 
-        // Get slowTick from system module
-        slowTick = getSlowTick();
+    // Set initial helicopter resting height
+    height_landed_adc = getHeight();
+#if defined(HEIGHT_ESTIMATOR) || defined(HAL_HOST)
+    heightEstimatorInit (height_landed_adc, CONTROL_PERIOD_MS);
+#endif
 
-        // Carry out UART transmission of helicopter data
-        UARTTransData (height_data, yaw_data, heli_duty, current_state, slowTick);
+    // Warm start from calibration, if it was taken on this rig: seed the
+    // hover duty now, and the heading the helicopter was left at once
+    // initialising starts, and fly on the tuned gains and calibrated
+    // coupling map if there are any
+    if (calibrationLoad (&calibration) &&
+        abs (height_landed_adc - calibration.landed_adc) <= CAL_LANDED_ADC_TOLERANCE) {
+        responseControlWarmStart (calibration.hover_duty);
+        yaw_seed_pending = calibration.yaw_rest != CAL_YAW_UNKNOWN;
+#ifndef GAIN_SCHEDULE
+        // The schedule's gains take the place of tuned ones
+        if (calibration.flags & CAL_FLAG_GAINS)
+            responseControlSetGains (&calibration.gains);
+#endif
+        if (calibration.flags & CAL_FLAG_COUPLING)
+            responseControlSetCoupling (&calibration.coupling);
+    } else {
+        calibration.landed_adc = height_landed_adc;
+        calibration.yaw_rest = CAL_YAW_UNKNOWN;
+        calibration.flags = 0;
     }
+
+    // Intialise helicopter state
+    current_state = landed;
+    ref_yaw_found = false;
+    hover_duty_found = false;
+
+    // Run the tasks
+    schedulerInit (tasks, sizeof (tasks) / sizeof (tasks[0]));
+    schedulerRun ();
+
+    return 0;
 }
+
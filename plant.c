@@ -0,0 +1,177 @@
+//*****************************************************************************
+//
+// plant.c
+//
+// Host simulation of the helicopter rig. Rotor speeds follow the PWM duty
+// with a first order lag; lift grows with the square of main rotor speed,
+// and the main rotor's reaction torque opposes the tail rotor. Heading is
+// reported through the quadrature pins one Gray code step at a time so the
+// firmware sees every edge, and the reference pin is high while the slot is
+// under the sensor.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#ifdef HAL_HOST
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "hal_host.h"
+#include "plant.h"
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+static plant_params_s params;
+static plant_state_s state;
+static uint32_t rng;                        // Noise generator state
+
+// Quadrature (A, B) levels in clockwise order
+static const bool quad_a[4] = {false, false, true, true};
+static const bool quad_b[4] = {false, true, true, false};
+
+//*****************************************************************************
+// Gaussian noise from a xorshift generator (Box-Muller)
+//*****************************************************************************
+static double
+plantUniform (void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (rng + 1.0) / 4294967297.0;
+}
+
+static double
+plantGaussian (void)
+{
+    return sqrt (-2.0 * log (plantUniform ())) * cos (2.0 * M_PI * plantUniform ());
+}
+
+//*****************************************************************************
+// Present the disc position and reference slot on the HAL inputs
+//*****************************************************************************
+static void
+plantEncoder (void)
+{
+    int32_t count = (int32_t) floor (state.yaw * PLANT_DISC_COUNT / 360.0);
+    double slot;
+
+    // One edge at a time towards the new position
+    while (state.count != count)
+    {
+        state.count += (count > state.count) ? 1 : -1;
+        halHostSetQuad (quad_a[state.count & 3], quad_b[state.count & 3]);
+    }
+
+    slot = fmod (state.yaw, 360.0);
+    if (slot < 0)
+        slot += 360.0;
+    halHostSetRef (slot < params.ref_width);
+}
+
+void
+plantDefaultParams (plant_params_s *p)
+{
+    p->hover_duty = 38.0;
+    p->gravity = 2.0;
+    p->height_damping = 3.0;
+    p->main_tau = 0.25;
+    p->tail_tau = 0.1;
+    p->tail_gain = 15.0;
+    p->coupling_gain = 9.9;
+    p->yaw_damping = 4.0;
+    p->landed_volts = 2.2;
+    p->noise_volts = 0.0025;
+    p->ref_width = 2.0;
+    p->initial_yaw = -100.0;
+    p->seed = 1;
+}
+
+void
+plantInit (const plant_params_s *p)
+{
+    params = *p;
+
+    state = (plant_state_s) {0};
+    state.yaw = params.initial_yaw;
+    state.count = (int32_t) floor (state.yaw * PLANT_DISC_COUNT / 360.0);
+    rng = params.seed ? params.seed : 1;
+
+    halHostSetQuad (quad_a[state.count & 3], quad_b[state.count & 3]);
+    halHostSetADCSource (plantADC);
+    halHostSetStep (plantStep, PLANT_STEP_RATE_HZ);
+}
+
+void
+plantStep (double dt)
+{
+    double lift;
+    double height_accel;
+    double yaw_accel;
+
+    // Rotor speeds lag the commanded duty
+    state.main_speed += (halHostPWMMainDuty () - state.main_speed) * dt / params.main_tau;
+    state.tail_speed += (halHostPWMTailDuty () - state.tail_speed) * dt / params.tail_tau;
+
+    // Vertical motion on the stand, limited to the height range
+    lift = state.main_speed / params.hover_duty;
+    height_accel = params.gravity * (lift * lift - 1.0) - params.height_damping * state.height_rate;
+    state.height_rate += height_accel * dt;
+    state.height += state.height_rate * dt;
+    if (state.height <= 0.0) {
+        state.height = 0.0;
+        if (state.height_rate < 0.0)
+            state.height_rate = 0.0;
+    } else if (state.height >= 1.0) {
+        state.height = 1.0;
+        if (state.height_rate > 0.0)
+            state.height_rate = 0.0;
+    }
+
+    // Tail thrust against the main rotor's reaction torque
+    yaw_accel = params.tail_gain * state.tail_speed - params.coupling_gain * state.main_speed
+                - params.yaw_damping * state.yaw_rate;
+    state.yaw_rate += yaw_accel * dt;
+    state.yaw += state.yaw_rate * dt;
+
+    plantEncoder ();
+}
+
+uint32_t
+plantADC (void)
+{
+    double volts = params.landed_volts - PLANT_RANGE_VOLTS * state.height
+                   + params.noise_volts * plantGaussian ();
+    double counts = volts / PLANT_ADC_VOLTS * PLANT_ADC_BITS;
+
+    if (counts < 0)
+        counts = 0;
+    else if (counts > PLANT_ADC_BITS)
+        counts = PLANT_ADC_BITS;
+
+    return (uint32_t) (counts + 0.5);
+}
+
+const plant_state_s *
+plantState (void)
+{
+    return &state;
+}
+
+double
+plantYawWrapped (void)
+{
+    double yaw = fmod (state.yaw, 360.0);
+
+    if (yaw > 180.0)
+        yaw -= 360.0;
+    else if (yaw <= -180.0)
+        yaw += 360.0;
+
+    return yaw;
+}
+
+#endif /* HAL_HOST */
@@ -0,0 +1,95 @@
+#ifndef PLANT_H_
+#define PLANT_H_
+
+// *******************************************************
+// plant.h
+//
+// Host simulation of the helicopter rig. Models the main and tail rotor
+// speeds, vertical motion on the stand, yaw dynamics with main to tail
+// torque coupling, the height sensor voltage and the 448 count quadrature
+// disc with its reference slot. Each step reads the rotor PWM outputs and
+// drives the ADC and encoder inputs of the host HAL.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define PLANT_STEP_RATE_HZ  10000   // Integration rate
+#define PLANT_DISC_COUNT    448     // Quadrature counts per revolution
+#define PLANT_RANGE_VOLTS   0.8     // Sensor voltage change over the height range
+#define PLANT_ADC_VOLTS     3.33    // ADC full scale voltage
+#define PLANT_ADC_BITS      4095
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef struct {
+    double hover_duty;          // Main duty holding the helicopter still (%)
+    double gravity;             // Net weight as acceleration (range/s^2)
+    double height_damping;      // Vertical damping (1/s)
+    double main_tau;            // Main rotor speed time constant (s)
+    double tail_tau;            // Tail rotor speed time constant (s)
+    double tail_gain;           // Yaw acceleration per % tail speed (deg/s^2)
+    double coupling_gain;       // Reverse yaw acceleration per % main speed (deg/s^2)
+    double yaw_damping;         // Yaw damping (1/s)
+    double landed_volts;        // Sensor voltage at the bottom of the range
+    double noise_volts;         // Sensor noise standard deviation
+    double ref_width;           // Reference slot width (deg)
+    double initial_yaw;         // Heading at power up, relative to the slot (deg)
+    uint32_t seed;              // Noise seed
+} plant_params_s;
+
+typedef struct {
+    double height;              // Fraction of the height range, 0 to 1
+    double height_rate;         // Range/s
+    double main_speed;          // Main rotor speed as equivalent duty (%)
+    double tail_speed;          // Tail rotor speed as equivalent duty (%)
+    double yaw;                 // Heading (deg, unwrapped)
+    double yaw_rate;            // Deg/s
+    int32_t count;              // Quadrature disc position (counts, unwrapped)
+} plant_state_s;
+
+//*****************************************************************************
+// Fill in the parameters of a typical rig
+//*****************************************************************************
+void
+plantDefaultParams (plant_params_s *params);
+
+//*****************************************************************************
+// Reset the plant and connect it to the host HAL
+//*****************************************************************************
+void
+plantInit (const plant_params_s *params);
+
+//*****************************************************************************
+// Advance the plant by dt seconds
+//*****************************************************************************
+void
+plantStep (double dt);
+
+//*****************************************************************************
+// Height sensor conversion, with noise
+//*****************************************************************************
+uint32_t
+plantADC (void);
+
+//*****************************************************************************
+// Current plant state
+//*****************************************************************************
+const plant_state_s *
+plantState (void);
+
+//*****************************************************************************
+// Heading wrapped to the firmware's 180 to -179 degree range
+//*****************************************************************************
+double
+plantYawWrapped (void);
+
+#endif /* PLANT_H_ */
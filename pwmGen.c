@@ -13,12 +13,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include "inc/hw_memmap.h"
-#include "driverlib/pin_map.h"
-#include "driverlib/gpio.h"
-#include "driverlib/pwm.h"
-#include "driverlib/sysctl.h"
 #include "pwmGen.h"
+#include "hal.h"
 
 /*******************************************
  *      Local prototypes
@@ -35,21 +31,11 @@ void setPWMTail (uint32_t u32Freq, float u32Duty);
 void
 initialisePWMMain (void)
 {
-    SysCtlPeripheralEnable(PWM_MAIN_PERIPH_PWM);
-    SysCtlPeripheralEnable(PWM_MAIN_PERIPH_GPIO);
+    // Configure the generator with the output disabled
+    halPWMMainInit();
 
-    GPIOPinConfigure(PWM_MAIN_GPIO_CONFIG);
-    GPIOPinTypePWM(PWM_MAIN_GPIO_BASE, PWM_MAIN_GPIO_PIN);
-
-    PWMGenConfigure(PWM_MAIN_BASE, PWM_MAIN_GEN,
-                    PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_NO_SYNC);
     // Set the initial PWM parameters
     setPWMMain (PWM_MAIN_FREQ, PWM_START_DUTY);
-
-    PWMGenEnable(PWM_MAIN_BASE, PWM_MAIN_GEN);
-
-    // Disable the output.  Repeat this call with 'true' to turn O/P on.
-    PWMOutputState(PWM_MAIN_BASE, PWM_MAIN_OUTBIT, false);
 }
 
 /*********************************************************
@@ -59,21 +45,11 @@ initialisePWMMain (void)
 void
 initialisePWMTail (void)
 {
-    SysCtlPeripheralEnable(PWM_TAIL_PERIPH_PWM);
-    SysCtlPeripheralEnable(PWM_TAIL_PERIPH_GPIO);
+    // Configure the generator with the output disabled
+    halPWMTailInit();
 
-    GPIOPinConfigure(PWM_TAIL_GPIO_CONFIG);
-    GPIOPinTypePWM(PWM_TAIL_GPIO_BASE, PWM_TAIL_GPIO_PIN);
-
-    PWMGenConfigure(PWM_TAIL_BASE, PWM_TAIL_GEN,
-                    PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_NO_SYNC);
     // Set the initial PWM parameters
     setPWMTail (PWM_TAIL_FREQ, PWM_START_DUTY);
-
-    PWMGenEnable(PWM_TAIL_BASE, PWM_TAIL_GEN);
-
-    // Disable the output.  Repeat this call with 'true' to turn O/P on.
-    PWMOutputState(PWM_TAIL_BASE, PWM_TAIL_OUTBIT, false);
 }
 
 /********************************************************
@@ -84,11 +60,9 @@ setPWMTail (uint32_t ui32Freq, float ui32Duty)
 {
     // Calculate the PWM period corresponding to the freq.
     uint32_t ui32Period =
-        SysCtlClockGet() / PWM_DIVIDER / ui32Freq;
+        halClockGet() / PWM_DIVIDER / ui32Freq;
 
-    PWMGenPeriodSet(PWM_TAIL_BASE, PWM_TAIL_GEN, ui32Period);
-    PWMPulseWidthSet(PWM_TAIL_BASE, PWM_TAIL_OUTNUM,
-        ui32Period * ui32Duty / 100);
+    halPWMTailSet(ui32Period, ui32Period * ui32Duty / 100);
 }
 
 /********************************************************
@@ -99,9 +73,7 @@ setPWMMain (uint32_t ui32Freq, float ui32Duty)
 {
     // Calculate the PWM period corresponding to the freq.
     uint32_t ui32Period =
-        SysCtlClockGet() / PWM_DIVIDER / ui32Freq;
+        halClockGet() / PWM_DIVIDER / ui32Freq;
 
-    PWMGenPeriodSet(PWM_MAIN_BASE, PWM_MAIN_GEN, ui32Period);
-    PWMPulseWidthSet(PWM_MAIN_BASE, PWM_MAIN_OUTNUM,
-        ui32Period * ui32Duty / 100);
+    halPWMMainSet(ui32Period, ui32Period * ui32Duty / 100);
 }
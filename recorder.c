@@ -0,0 +1,291 @@
+//*****************************************************************************
+//
+// recorder.c
+//
+// Flight data recorder: ring buffer of control steps frozen around a
+// trigger, and the frames it is sent in. The control interrupt is the only
+// writer of the ring; the main loop only reads it once the interrupt has
+// frozen it, and asks for freezing and re-arming through request counts
+// that the interrupt carries out, so neither side masks interrupts.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "recorder.h"
+#include "telemetry.h"
+#include "flight_mode.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define RECORDER_POST   (RECORDER_LEN - RECORDER_PRE)   // Steps after the trigger
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef enum {
+    RECORDER_ARMED,             // Recording, waiting for a trigger
+    RECORDER_TRIGGERED,         // Recording the post-trigger window
+    RECORDER_FROZEN,            // Holding a capture
+} recorder_state_t;
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+// Written by the interrupt, read by the main loop once frozen
+static recorder_step_s ring[RECORDER_LEN];
+static uint32_t head;                       // Steps recorded since armed
+static uint32_t trigger_at;                 // Value of head at the trigger step
+static uint8_t reason;                      // Trigger that fired, 0 for none
+static uint32_t post_left;                  // Steps still to record after the trigger
+static uint8_t last_mode;
+static volatile recorder_state_t state;
+static uint32_t freezes;                    // Requests carried out by the interrupt
+static uint32_t arms;
+
+// Written by the main loop
+static volatile uint32_t freeze_requests;
+static volatile uint32_t arm_requests;
+static uint16_t rate;
+static bool dumping;
+static uint32_t dump_next;                  // 0 for the header, then data frame + 1
+
+//*****************************************************************************
+// Little endian packing
+//*****************************************************************************
+static uint8_t *
+put16 (uint8_t *p, uint16_t value)
+{
+    *p++ = value;
+    *p++ = value >> 8;
+    return p;
+}
+
+static uint16_t
+get16 (const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+//*****************************************************************************
+// Clear and arm the recorder
+//*****************************************************************************
+void
+recorderInit (uint16_t rate_hz)
+{
+    rate = rate_hz;
+    head = 0;
+    reason = 0;
+    dumping = false;
+    freezes = freeze_requests;
+    arms = arm_requests;
+    state = RECORDER_ARMED;
+}
+
+//*****************************************************************************
+// Trigger conditions met by a step
+//*****************************************************************************
+static uint8_t
+recorderTriggers (const recorder_step_s *step)
+{
+    uint8_t mode = step->flags & RECORDER_FLAG_MODE;
+    uint8_t fired = 0;
+    int16_t yaw_error;
+
+    if (head && mode != last_mode)
+        fired |= RECORDER_TRIGGER_STATE;
+
+    if (mode == flying) {
+        if (step->flags & (RECORDER_FLAG_MAIN_SAT | RECORDER_FLAG_TAIL_SAT))
+            fired |= RECORDER_TRIGGER_SATURATION;
+
+        // Yaw error the shortest way round
+        yaw_error = step->yaw_target - step->yaw_current;
+        if (yaw_error > 180)
+            yaw_error -= 360;
+        else if (yaw_error < -180)
+            yaw_error += 360;
+
+        if (step->height_target - step->height_current > RECORDER_HEIGHT_ERROR ||
+            step->height_current - step->height_target > RECORDER_HEIGHT_ERROR ||
+            yaw_error > RECORDER_YAW_ERROR || yaw_error < -RECORDER_YAW_ERROR)
+            fired |= RECORDER_TRIGGER_ERROR;
+    }
+
+    return fired & RECORDER_TRIGGERS;
+}
+
+//*****************************************************************************
+// Record one step, from the control interrupt
+//*****************************************************************************
+void
+recorderStep (recorder_step_s *step)
+{
+    if (state == RECORDER_FROZEN) {
+        if (arms == arm_requests)
+            return;
+
+        // Start a new capture, dropping any freeze asked for meanwhile
+        arms = arm_requests;
+        freezes = freeze_requests;
+        head = 0;
+        reason = 0;
+        state = RECORDER_ARMED;
+    }
+
+    if (state == RECORDER_ARMED) {
+        reason = recorderTriggers (step);
+        if (reason) {
+            step->flags |= RECORDER_FLAG_TRIGGER;
+            trigger_at = head;
+            post_left = RECORDER_POST + 1;
+            state = RECORDER_TRIGGERED;
+        }
+    }
+
+    ring[head % RECORDER_LEN] = *step;
+    head++;
+    last_mode = step->flags & RECORDER_FLAG_MODE;
+
+    if (state == RECORDER_TRIGGERED && --post_left == 0)
+        state = RECORDER_FROZEN;
+
+    if (freezes != freeze_requests) {
+        freezes = freeze_requests;
+        state = RECORDER_FROZEN;
+    }
+}
+
+//*****************************************************************************
+// Start sending the capture
+//*****************************************************************************
+void
+recorderDump (void)
+{
+    if (dumping)
+        return;
+
+    dumping = true;
+    dump_next = 0;
+    freeze_requests++;
+}
+
+bool
+recorderDumping (void)
+{
+    return dumping;
+}
+
+//*****************************************************************************
+// Encode the next frame of the capture
+//*****************************************************************************
+uint32_t
+recorderDumpFrame (uint8_t *out)
+{
+    uint8_t payload[RECORDER_DATA_LEN];
+    uint8_t *p = payload;
+    const recorder_step_s *step;
+    uint32_t steps;
+    uint32_t first;
+    uint32_t frames;
+    uint32_t count;
+    uint32_t i;
+
+    if (!dumping || state != RECORDER_FROZEN)
+        return 0;
+
+    // The ring is read only after the interrupt has frozen it
+    atomic_signal_fence (memory_order_seq_cst);
+
+    steps = head < RECORDER_LEN ? head : RECORDER_LEN;
+    first = head - steps;
+    frames = (steps + RECORDER_FRAME_STEPS - 1) / RECORDER_FRAME_STEPS;
+
+    if (dump_next == 0) {
+        *p++ = 'H';
+        *p++ = RECORDER_VERSION;
+        *p++ = RECORDER_STEP_SIZE;
+        p = put16 (p, rate);
+        p = put16 (p, steps);
+        p = put16 (p, reason ? trigger_at - first : RECORDER_NO_TRIGGER);
+        *p++ = reason;
+        p = put16 (p, frames);
+    } else {
+        i = (dump_next - 1) * RECORDER_FRAME_STEPS;
+        count = steps - i < RECORDER_FRAME_STEPS ? steps - i : RECORDER_FRAME_STEPS;
+
+        *p++ = 'D';
+        p = put16 (p, dump_next - 1);
+        *p++ = count;
+        for (; count; count--, i++)
+        {
+            step = &ring[(first + i) % RECORDER_LEN];
+            *p++ = step->height_current;
+            *p++ = step->height_target;
+            p = put16 (p, step->yaw_current);
+            p = put16 (p, step->yaw_target);
+            *p++ = step->duty_main;
+            *p++ = step->duty_tail;
+            p = put16 (p, step->integral_main);
+            p = put16 (p, step->integral_tail);
+            *p++ = step->flags;
+        }
+    }
+
+    // Done: let the interrupt record again
+    if (++dump_next > frames) {
+        dumping = false;
+        atomic_signal_fence (memory_order_seq_cst);
+        arm_requests++;
+    }
+
+    // A leading zero ends any text sent before the frame
+    out[0] = 0;
+    return 1 + telemetryPack (payload, p - payload, out + 1);
+}
+
+//*****************************************************************************
+// Host side decoding of a payload
+//*****************************************************************************
+int
+recorderDecode (const uint8_t *payload, int32_t length, recorder_header_s *header,
+                uint16_t *index, recorder_step_s *steps, uint32_t *count)
+{
+    const uint8_t *p = payload;
+    uint32_t i;
+
+    if (length == RECORDER_HEADER_LEN && p[0] == 'H' && p[1] == RECORDER_VERSION &&
+        p[2] == RECORDER_STEP_SIZE) {
+        header->rate_hz = get16 (p + 3);
+        header->steps = get16 (p + 5);
+        header->trigger = get16 (p + 7);
+        header->reason = p[9];
+        header->frames = get16 (p + 10);
+        return 'H';
+    }
+
+    if (length < 4 || p[0] != 'D' || p[3] > RECORDER_FRAME_STEPS ||
+        length != 4 + p[3] * RECORDER_STEP_SIZE)
+        return 0;
+
+    *index = get16 (p + 1);
+    *count = p[3];
+    for (i = 0, p += 4; i < *count; i++, p += RECORDER_STEP_SIZE)
+    {
+        steps[i].height_current = p[0];
+        steps[i].height_target = p[1];
+        steps[i].yaw_current = get16 (p + 2);
+        steps[i].yaw_target = get16 (p + 4);
+        steps[i].duty_main = p[6];
+        steps[i].duty_tail = p[7];
+        steps[i].integral_main = get16 (p + 8);
+        steps[i].integral_tail = get16 (p + 10);
+        steps[i].flags = p[12];
+    }
+
+    return 'D';
+}
@@ -0,0 +1,145 @@
+#ifndef RECORDER_H_
+#define RECORDER_H_
+
+// *******************************************************
+// recorder.h
+//
+// Flight data recorder. The control interrupt hands every step to
+// recorderStep, which keeps the last RECORDER_LEN steps in a ring buffer
+// in RAM. When a trigger condition is met the recorder keeps going for the
+// post-trigger window and then freezes, leaving RECORDER_PRE steps up to
+// and including the trigger and the rest after it.
+//
+// Once frozen the capture is sent as telemetry.h frames (CRC and COBS)
+// with the payloads below, each preceded by a zero so that it can follow
+// text on the same link; then the recorder arms again. tools/recDecode.c
+// turns a UART capture into CSV.
+//
+//   Header:  'H', version u8, step size u8, rate_hz u16, steps u16,
+//            trigger index u16 (RECORDER_NO_TRIGGER if frozen on request),
+//            trigger reason u8, frames to follow u16
+//   Data:    'D', frame index u16, step count u8, then each step as
+//            recorder_step_s in field order, little endian
+//
+// Built in when FLIGHT_RECORDER is defined. No hardware dependencies, so
+// the host decoder builds it unchanged.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "telemetry.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#ifndef RECORDER_LEN
+#define RECORDER_LEN            1024    // Steps held, 13 bytes each
+#endif
+#ifndef RECORDER_PRE
+#define RECORDER_PRE            256     // Steps kept up to and including the trigger
+#endif
+#ifndef RECORDER_TRIGGERS
+#define RECORDER_TRIGGERS       (RECORDER_TRIGGER_SATURATION | RECORDER_TRIGGER_ERROR)
+#endif
+#ifndef RECORDER_HEIGHT_ERROR
+#define RECORDER_HEIGHT_ERROR   25      // Height error trigger (%)
+#endif
+#ifndef RECORDER_YAW_ERROR
+#define RECORDER_YAW_ERROR      90      // Yaw error trigger (deg)
+#endif
+
+// Trigger conditions, as a mask. Saturation and error only count while
+// flying; a state change is any change of flight mode.
+#define RECORDER_TRIGGER_STATE      0x01
+#define RECORDER_TRIGGER_SATURATION 0x02
+#define RECORDER_TRIGGER_ERROR      0x04
+
+// Step flags
+#define RECORDER_FLAG_MODE          0x07    // Flight mode
+#define RECORDER_FLAG_MAIN_SAT      0x08    // Main duty at a limit under PI control
+#define RECORDER_FLAG_TAIL_SAT      0x10    // Tail duty at a limit under PI control
+#define RECORDER_FLAG_TRIGGER       0x20    // The step that triggered the capture
+
+#define RECORDER_VERSION        2
+#define RECORDER_STEP_SIZE      13      // Bytes per step on the wire
+#define RECORDER_FRAME_STEPS    16      // Steps per data frame
+#define RECORDER_NO_TRIGGER     0xFFFF
+#define RECORDER_HEADER_LEN     12
+#define RECORDER_DATA_LEN       (4 + RECORDER_FRAME_STEPS * RECORDER_STEP_SIZE)
+#define RECORDER_FRAME_LEN      (1 + TELEMETRY_PACKED_LEN (RECORDER_DATA_LEN))
+#define RECORDER_CMD_DUMP       'd'     // UART command to send the capture now
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+// One control step. Packed to keep the ring buffer small; the Cortex-M4
+// handles the unaligned halfwords.
+typedef struct __attribute__ ((packed)) {
+    int8_t height_current;      // Height (%)
+    int8_t height_target;
+    int16_t yaw_current;        // Yaw (deg)
+    int16_t yaw_target;
+    uint8_t duty_main;          // Duties (%)
+    uint8_t duty_tail;
+    int16_t integral_main;      // Integral values (%, Q8.8)
+    int16_t integral_tail;
+    uint8_t flags;              // Flight mode and RECORDER_FLAG_*
+} recorder_step_s;
+
+// Capture description, sent in the header frame
+typedef struct {
+    uint16_t rate_hz;           // Steps per second
+    uint16_t steps;             // Steps in the capture
+    uint16_t trigger;           // Index of the trigger step, or RECORDER_NO_TRIGGER
+    uint8_t reason;             // RECORDER_TRIGGER_* that fired
+    uint16_t frames;            // Data frames after the header
+} recorder_header_s;
+
+//*****************************************************************************
+// Clear and arm the recorder; rate_hz is the control step rate
+//*****************************************************************************
+void
+recorderInit (uint16_t rate_hz);
+
+//*****************************************************************************
+// Record one step, from the control interrupt. Sets RECORDER_FLAG_TRIGGER
+// on the step if it triggers the capture.
+//*****************************************************************************
+void
+recorderStep (recorder_step_s *step);
+
+//*****************************************************************************
+// Send the capture: freeze the recorder at its next step if it has not
+// frozen already, then have recorderDumpFrame return the frames
+//*****************************************************************************
+void
+recorderDump (void);
+
+//*****************************************************************************
+// True from recorderDump until the last frame has been returned
+//*****************************************************************************
+bool
+recorderDumping (void);
+
+//*****************************************************************************
+// Encode the next frame of the capture into out (RECORDER_FRAME_LEN bytes),
+// returning its length, or 0 if the recorder has not frozen yet or the dump
+// is complete. The recorder arms again after the last frame.
+//*****************************************************************************
+uint32_t
+recorderDumpFrame (uint8_t *out);
+
+//*****************************************************************************
+// Host side: decode a payload from telemetryUnpack. Returns 'H' with header
+// filled, 'D' with index set and count steps written to steps
+// (RECORDER_FRAME_STEPS), or 0 if it is not a recorder payload.
+//*****************************************************************************
+int
+recorderDecode (const uint8_t *payload, int32_t length, recorder_header_s *header,
+                uint16_t *index, recorder_step_s *steps, uint32_t *count);
+
+#endif /* RECORDER_H_ */
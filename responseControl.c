@@ -5,19 +5,59 @@
 // Motion control for helicopter. Takes current helicopter state, position and
 // target position from the main and drives the rotors appropriately.
 //
+// The main loop decides what the control interrupt should do and publishes
+// it as a control_input_s through a double buffer; the interrupt is the
+// only writer of the rotor PWM and publishes the duties through a sequence
+// lock (handoff.h). Neither side masks interrupts or sees a torn structure.
+//
 // Authors: T.R. Peterson, M.G. Gardyne, M. Comber
-// Last modified: 19/5/2021
+// Last modified: 18/10/2026
 //
 
 #include <stdint.h>
+#include <stdlib.h>
 #include "responseControl.h"
-#include "driverlib/timer.h"
 #include "yaw.h"
 #include "altitude.h"
 #include "pwmGen.h"
 #include "flight_mode.h"
-#include "inc/hw_memmap.h"
-#include "driverlib/sysctl.h"
+#include "isrProfile.h"
+#include "isrLatency.h"
+#include "fixedPoint.h"
+#include "handoff.h"
+#include "recorder.h"
+#include "autotune.h"
+#include "gainSchedule.h"
+#include "coupling.h"
+#include "hal.h"
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+// Fixed point (Q8.24) copies of the PI gains
+typedef struct {
+    q24_t proportional_main;
+    q24_t integral_main;
+    q24_t proportional_tail;
+    q24_t integral_tail;
+} pi_gains_q_s;
+
+// Everything the control interrupt needs from the main loop
+typedef struct {
+    flight_mode state;              // Flight state the inputs were set for
+    height_data_s height;           // Height current and target values
+    yaw_data_s yaw;                 // Yaw current and target values
+    bool main_enable;               // PI control of the main rotor
+    bool tail_enable;               // PI control of the tail rotor
+    duty_cycle_s duty;              // Duties for rotors not under PI control
+    uint32_t offset_duty_main;      // Helicopter hover duty
+    pi_gains_s gains;               // PI gains, float and Q8.24
+    pi_gains_q_s gains_q;
+    uint32_t integral_resets;       // Incremented to clear the integrals
+    coupling_map_s coupling;        // Tail feed-forward map
+    q24_t coupling_transfer;        // Map change to take out of the tail integral
+    uint32_t coupling_transfers;    // Incremented with each change
+} control_input_s;
 
 //*****************************************************************************
 // Global variables
@@ -26,38 +66,244 @@
 static float integral_main;     // Cumulative main integral value
 static float integral_tail;     // Cumulative tail integral value
 
-// PI gains
-static float integral_gain_main = 0.00009;   // Integral control gain for main rotor
-static float integral_gain_tail = 0.0000375; // Integral control gain for tail rotor
-static float proportional_gain_main = 0.65;  // Proportional control gain for main rotor
-static float proportional_gain_tail = 0.6;   // Proportional control gain for tail rotor
+// PI gains used while flying, hand tuned or set by autotune
+static pi_gains_s gains = {
+    .proportional_main = 0.65,
+    .integral_main = 0.0001,
+    .proportional_tail = 0.6,
+    .integral_tail = 0.0000375,
+};
 
-// Altitude data
-static height_data_s height_data;       // Height current and target values
-static uint32_t height_sweep_duty = 30; // Main duty for reference orientation sweep
-static uint32_t offset_duty_main = 30;  // Helicopter hover duty
+// Fixed point (Q8.24) copies of the integral values
+static q24_t integral_main_q;
+static q24_t integral_tail_q;
+
+// Tail feed-forward for the current step, from the coupling map
+static q24_t coupling_tail;
 
-// Yaw data
-static yaw_data_s yaw_data;             // Yaw current and target values
+// Sweep duties
+static uint32_t height_sweep_duty = 30; // Main duty for reference orientation sweep
 static uint32_t yaw_sweep_duty = 50;    // Tail duty for reference orientation sweep
 
 // Current helicopter state
 flight_mode current_state;              // Current helicopter state
-bool PI_main_enable = false;            // PI main enable
-bool PI_tail_enable = false;            // PI tail enable
 bool hover_duty_found = false;          // Hover duty found flag
 
-// Helicopter duty cycle
-duty_cycle_s heli_duty;
+// Main loop to interrupt handoff
+static control_input_s control_input = {
+    .offset_duty_main = 30,
+};                                      // Main loop's working copy
+static control_input_s control_slots[2];
+static double_buffer_s control_buffer;
+static const control_input_s *input;    // Front slot, during the interrupt
+static uint32_t integral_resets;        // Resets carried out by the interrupt
+static uint32_t coupling_transfers;     // Map changes taken out of the tail integral
+static bool warm_start;                 // Hover duty seeded from calibration
+
+// Helicopter duty cycle, written by the interrupt
+static duty_cycle_s heli_duty;
+static seqlock_s heli_duty_lock;
 
 // Counter used for gradual duty cycle decrement during landing
 int landing_count = 0;
 
+#ifdef PI_LOCKSTEP
+// Float and fixed point controllers run side by side for comparison
+typedef struct {
+    uint32_t steps;             // Control steps compared
+    uint32_t mismatches;        // Steps where the duties differed
+    uint32_t max_difference;    // Largest duty difference (%)
+    float max_integral_error;   // Largest integral value difference (%)
+    uint64_t float_cycles;      // Total float controller cost
+    uint64_t fixed_cycles;      // Total fixed point controller cost
+} lockstep_s;
+
+static lockstep_s lockstep_main;
+static lockstep_s lockstep_tail;
+#endif
+
 //*****************************************************************************
 // Function prototypes
 //*****************************************************************************
 int32_t dutyResponseMain();
 int32_t dutyResponseTail();
+int32_t dutyResponseMainFixed();
+int32_t dutyResponseTailFixed();
+static int16_t yawError (yaw_data_s yaw);
+
+#ifdef PI_LOCKSTEP
+//*****************************************************************************
+// Run both controllers for one step, recording cost and divergence, and
+// return the duty of the one selected by PI_FIXED_POINT
+//*****************************************************************************
+static int32_t
+lockstepStep (lockstep_s *ls, int32_t (*float_pi)(void), int32_t (*fixed_pi)(void),
+              float *integral, q24_t *integral_q)
+{
+    uint32_t start;
+    int32_t float_duty;
+    int32_t fixed_duty;
+    uint32_t difference;
+    float integral_error;
+
+    // Alternate the order so neither benefits from running second
+    if (ls->steps & 1) {
+        start = halCycleCount ();
+        float_duty = float_pi ();
+        ls->float_cycles += halCycleCount () - start;
+        start = halCycleCount ();
+        fixed_duty = fixed_pi ();
+        ls->fixed_cycles += halCycleCount () - start;
+    } else {
+        start = halCycleCount ();
+        fixed_duty = fixed_pi ();
+        ls->fixed_cycles += halCycleCount () - start;
+        start = halCycleCount ();
+        float_duty = float_pi ();
+        ls->float_cycles += halCycleCount () - start;
+    }
+
+    difference = abs (float_duty - fixed_duty);
+    if (difference) {
+        ls->mismatches++;
+        if (difference > ls->max_difference)
+            ls->max_difference = difference;
+    }
+
+    integral_error = *integral - (float) *integral_q / (1 << Q24_SHIFT);
+    if (integral_error < 0)
+        integral_error = -integral_error;
+    if (integral_error > ls->max_integral_error)
+        ls->max_integral_error = integral_error;
+
+    ls->steps++;
+
+#ifdef PI_FIXED_POINT
+    return fixed_duty;
+#else
+    return float_duty;
+#endif
+}
+#endif
+
+//*****************************************************************************
+// Rotor duties from the PI implementation selected at build time
+//*****************************************************************************
+static int32_t
+responseMain (void)
+{
+#if defined(PI_LOCKSTEP)
+    return lockstepStep (&lockstep_main, dutyResponseMain, dutyResponseMainFixed,
+                         &integral_main, &integral_main_q);
+#elif defined(PI_FIXED_POINT)
+    return dutyResponseMainFixed ();
+#else
+    return dutyResponseMain ();
+#endif
+}
+
+static int32_t
+responseTail (void)
+{
+#if defined(PI_LOCKSTEP)
+    return lockstepStep (&lockstep_tail, dutyResponseTail, dutyResponseTailFixed,
+                         &integral_tail, &integral_tail_q);
+#elif defined(PI_FIXED_POINT)
+    return dutyResponseTailFixed ();
+#else
+    return dutyResponseTail ();
+#endif
+}
+
+//*****************************************************************************
+// Set the main integral gain for both controller implementations
+//*****************************************************************************
+static void
+setIntegralGainMain (float gain)
+{
+    control_input.gains.integral_main = gain;
+    control_input.gains_q.integral_main = Q24_FROM_FLOAT (gain);
+}
+
+//*****************************************************************************
+// Set all the PI gains for both controller implementations
+//*****************************************************************************
+static void
+setGains (const pi_gains_s *set)
+{
+    control_input.gains = *set;
+    control_input.gains_q.proportional_main = Q24_FROM_FLOAT (set->proportional_main);
+    control_input.gains_q.proportional_tail = Q24_FROM_FLOAT (set->proportional_tail);
+    control_input.gains_q.integral_tail = Q24_FROM_FLOAT (set->integral_tail);
+    setIntegralGainMain (set->integral_main);
+}
+
+//*****************************************************************************
+// Clear the cumulative integral values, in the interrupt
+//*****************************************************************************
+static void
+resetIntegrals (void)
+{
+    integral_main = 0;
+    integral_tail = 0;
+    integral_main_q = 0;
+    integral_tail_q = 0;
+}
+
+//*****************************************************************************
+// Pass the main loop's working copy to the interrupt
+//*****************************************************************************
+static void
+publishControlInput (void)
+{
+    doubleBufferPublish (&control_buffer, control_slots, &control_input,
+                         sizeof (control_input));
+}
+
+#ifdef FLIGHT_RECORDER
+//*****************************************************************************
+// Hand the step just taken to the flight data recorder, in the interrupt
+//*****************************************************************************
+static int16_t
+recordClamp (int32_t value, int32_t limit)
+{
+    if (value > limit - 1)
+        return limit - 1;
+    if (value < -limit)
+        return -limit;
+    return value;
+}
+
+static void
+recordStep (duty_cycle_s duty)
+{
+    recorder_step_s step;
+
+    step.height_current = recordClamp (input->height.current, 128);
+    step.height_target = recordClamp (input->height.target, 128);
+    step.yaw_current = input->yaw.current;
+    step.yaw_target = input->yaw.target;
+    step.duty_main = duty.main;
+    step.duty_tail = duty.tail;
+
+    // Integral values of the controller in use, as Q8.8
+#ifdef PI_FIXED_POINT
+    step.integral_main = recordClamp (integral_main_q >> (Q24_SHIFT - 8), 32768);
+    step.integral_tail = recordClamp (integral_tail_q >> (Q24_SHIFT - 8), 32768);
+#else
+    step.integral_main = recordClamp (integral_main * 256, 32768);
+    step.integral_tail = recordClamp (integral_tail * 256, 32768);
+#endif
+
+    step.flags = input->state & RECORDER_FLAG_MODE;
+    if (input->main_enable && (duty.main >= MAX_DUTY_MAIN || duty.main <= MIN_DUTY_MAIN))
+        step.flags |= RECORDER_FLAG_MAIN_SAT;
+    if (input->tail_enable && (duty.tail >= MAX_DUTY_TAIL || duty.tail <= MIN_DUTY_TAIL))
+        step.flags |= RECORDER_FLAG_TAIL_SAT;
+
+    recorderStep (&step);
+}
+#endif
 
 //*****************************************************************************
 // The interrupt handler for the for timer interrupt.
@@ -65,29 +311,48 @@ int32_t dutyResponseTail();
 void
 responseControlIntHandler (void)
 {
+    LATENCY_ENTER(HAL_INT_CONTROL_TIMER);
+    duty_cycle_s duty;
+    PROFILE_START();
+
     // Clear the timer interrupt flag
-    TimerIntClear(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
+    halControlTimerIntClear();
 
-    // PI control for main rotor
-    if (PI_main_enable) {
+    // Latest inputs from the main loop
+    input = doubleBufferFront (&control_buffer, control_slots, sizeof (control_input));
+    if (input->integral_resets != integral_resets) {
+        integral_resets = input->integral_resets;
+        resetIntegrals ();
+    }
+    if (input->coupling_transfers != coupling_transfers) {
+        coupling_transfers = input->coupling_transfers;
+        integral_tail -= (float) input->coupling_transfer / (1 << Q24_SHIFT);
+        integral_tail_q = q24Add (integral_tail_q, -input->coupling_transfer);
+    }
 
-        // Calculate main rotor PWM using PI control
-        heli_duty.main = dutyResponseMain();
+    // Main rotor duty using PI control, or as set by the main loop. The
+    // controllers clamp to at least MIN_DUTY_MAIN, so never go negative
+    duty.main = input->main_enable ? (uint32_t) responseMain() : input->duty.main;
 
-        // Set duty value
-        setPWMMain (PWM_MAIN_FREQ, heli_duty.main);
-    }
+    // Tail feed-forward against the main rotor at that duty
+    coupling_tail = couplingFeedForward (&input->coupling, duty.main);
 
-    // PI control for tail rotor
-    if (PI_tail_enable) {
+    // Tail rotor duty using PI control, or as set by the main loop,
+    // likewise at least MIN_DUTY_TAIL
+    duty.tail = input->tail_enable ? (uint32_t) responseTail() : input->duty.tail;
 
-        // Calculate tail rotor PWM using PI control
-        heli_duty.tail = dutyResponseTail();
+    // Set duty values
+    setPWMMain (PWM_MAIN_FREQ, duty.main);
+    setPWMTail (PWM_TAIL_FREQ, duty.tail);
 
-        // Set duty value
-        setPWMTail (PWM_TAIL_FREQ, heli_duty.tail);
-    }
+    seqlockWrite (&heli_duty_lock, &heli_duty, &duty, sizeof (duty));
+
+#ifdef FLIGHT_RECORDER
+    recordStep (duty);
+#endif
 
+    PROFILE_STOP(PROFILE_RESPONSE_CONTROL_INT);
+    LATENCY_EXIT(HAL_INT_CONTROL_TIMER);
 }
 
 //*****************************************************************************
@@ -96,23 +361,19 @@ responseControlIntHandler (void)
 void
 initResponseTimer (void)
 {
-    // The Timer0 peripheral must be enabled for use.
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
-
-    // Configure Timer0B as a 16-bit periodic timer.
-    TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC);
+    // Gains, with their fixed point copies, and the uncalibrated coupling
+    setGains (&gains);
+    couplingMapDefault (&control_input.coupling);
 
-    // Set timer value
-    TimerLoadSet(TIMER0_BASE, TIMER_A, SysCtlClockGet() / TIMER_RATE);
+    // Inputs for the first interrupt
+    publishControlInput ();
 
-    // Register interrupt
-    TimerIntRegister(TIMER0_BASE, TIMER_A, responseControlIntHandler);
+#ifdef FLIGHT_RECORDER
+    recorderInit (TIMER_RATE);
+#endif
 
-    // Configure the Timer0B interrupt for timer timeout.
-    TimerIntEnable(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
-
-    // Enable timer
-    TimerEnable(TIMER0_BASE, TIMER_A);
+    // Periodic timer interrupt at TIMER_RATE
+    halControlTimerInit(halClockGet() / TIMER_RATE, responseControlIntHandler);
 }
 
 //*****************************************************************************
@@ -121,45 +382,59 @@ initResponseTimer (void)
 void
 updateResponseControl (height_data_s height_data_in, yaw_data_s yaw_data_in)
 {
+    // Duties last applied by the control interrupt
+    duty_cycle_s duty = getHeliDuty();
+    flight_mode last_state = control_input.state;
+    autotune_phase phase;
+#ifdef GAIN_SCHEDULE
+    pi_gains_s scheduled;
+#endif
+
     // Update helicopter state
      current_state = getState();
 
      // Update state data
-     height_data = height_data_in;
-     yaw_data = yaw_data_in;
+     control_input.state = current_state;
+     control_input.height = height_data_in;
+     control_input.yaw = yaw_data_in;
+
+#ifdef GAIN_SCHEDULE
+     // Back to the base gains once no longer flying on the schedule
+     if (last_state == flying && current_state != flying)
+         setGains (&gains);
+#endif
 
      // Update PWM signals using state approriate method
      switch (current_state)
      {
      case landed:
          // Turn off rotors
-         PI_main_enable = false;
-         PI_tail_enable = false;
-         heli_duty.tail = 0;
-         heli_duty.main = 0;
-         setPWMMain (PWM_MAIN_FREQ, heli_duty.main);
-         setPWMTail (PWM_TAIL_FREQ, heli_duty.tail);
+         control_input.main_enable = false;
+         control_input.tail_enable = false;
+         control_input.duty.tail = 0;
+         control_input.duty.main = 0;
          break;
      case initialising:
 
          // Find hover duty cycle
          if (!hover_duty_found) {
-             // Increase integral constant for temporary faster wind up
-             integral_gain_main = 0.001;
+             // Increase integral constant for temporary faster wind up, or
+             // only verify a hover duty seeded from calibration
+             setIntegralGainMain (warm_start ? gains.integral_main : 0.001);
 
              // Enable PI control
-             PI_main_enable = true;
-             PI_tail_enable = true;
+             control_input.main_enable = true;
+             control_input.tail_enable = true;
 
              // Update hover duty found when at hover point
-             if (height_data.current == height_data.target) {
+             if (control_input.height.current == control_input.height.target) {
                  hover_duty_found = true;
 
                  // Set offset value
-                 offset_duty_main = heli_duty.main;
+                 control_input.offset_duty_main = duty.main;
 
                  // Calculate yaw sweep duty based on offset
-                 yaw_sweep_duty = offset_duty_main + 15;
+                 yaw_sweep_duty = control_input.offset_duty_main + 15;
 
                  // Limit yaw sweep to maximum value
                  if (yaw_sweep_duty > MAX_DUTY_TAIL) {
@@ -171,48 +446,83 @@ updateResponseControl (height_data_s height_data_in, yaw_data_s yaw_data_in)
          // Find reference yaw once hover point found
          if (refFound() && hover_duty_found) {
              // Reset main integral constant
-             integral_gain_main = 0.0001;
+             setIntegralGainMain (gains.integral_main);
 
              //Enable PI control
-             PI_main_enable = true;
-             PI_tail_enable = true;
+             control_input.main_enable = true;
+             control_input.tail_enable = true;
 
              // Reset cumulative integral values
-             integral_main = 0;
-             integral_tail = 0;
+             control_input.integral_resets++;
          } else if (hover_duty_found) {
-             // Disable PI control
-             PI_main_enable = false;
-             PI_tail_enable = false;
+             // Disable PI control, except to hold the tail at the approach
+             // point for a heading seeded from calibration
+             control_input.main_enable = false;
+             control_input.tail_enable = yawApproaching();
 
              // Set duty to sweeping values during intialisation
-             heli_duty.tail = yaw_sweep_duty;
-             heli_duty.main = height_sweep_duty;
-
-             // Set duty values
-             setPWMTail (PWM_TAIL_FREQ, heli_duty.tail);
-             setPWMMain (PWM_MAIN_FREQ, heli_duty.main);
+             control_input.duty.tail = yaw_sweep_duty;
+             control_input.duty.main = height_sweep_duty;
          }
          break;
      case landing:
-         // Disable PI control for only main rotor
-         PI_main_enable = false;
+         // Switched down during autotune: abandon the experiment and put
+         // the tail back under PI control to bring the yaw round to the
+         // reference, starting the main rotor from the hover duty rather
+         // than the relay's step
+         if (last_state == autotuning) {
+             autotuneAbort ();
+             control_input.tail_enable = true;
+             if (!control_input.main_enable)
+                 control_input.duty.main = control_input.offset_duty_main;
+         }
+
+         // Disable PI control for only main rotor, holding its last duty
+         if (control_input.main_enable) {
+             control_input.main_enable = false;
+             control_input.duty.main = duty.main;
+         }
 
          // Decrement main duty gradually, while at correct yaw orientation, until at minimum value for smooth decent
          landing_count++;
-         if (landing_count >= 5 && heli_duty.main > (offset_duty_main - 10) && yaw_data.current > -5 && yaw_data.current < 5) {
-             heli_duty.main = heli_duty.main - 1;
+         if (landing_count >= 5 && control_input.duty.main > (control_input.offset_duty_main - 10) && control_input.yaw.current > -5 && control_input.yaw.current < 5) {
+             control_input.duty.main = control_input.duty.main - 1;
              landing_count = 0;
          }
-
-         // Update main duty value
-         setPWMMain (PWM_MAIN_FREQ, heli_duty.main);
          break;
      case flying:
          // Allow full PI control
-         PI_main_enable = true;
-         PI_tail_enable = true;
+         control_input.main_enable = true;
+         control_input.tail_enable = true;
+
+#ifdef GAIN_SCHEDULE
+         // Gains for the height and direction of travel
+         gainScheduleLookup (control_input.height.current,
+                             control_input.height.target - control_input.height.current,
+                             &scheduled);
+         setGains (&scheduled);
+#endif
+
+         // Calibrate the coupling map while holding the setpoints, moving
+         // what the map gains out of the tail integral
+         if (couplingLearn (&control_input.coupling,
+                            control_input.height.target - control_input.height.current,
+                            yawError (control_input.yaw), duty.main, duty.tail,
+                            &control_input.coupling_transfer))
+             control_input.coupling_transfers++;
+         break;
+     case autotuning:
+         // Relay on one rotor at a time, the other under PI control
+         phase = autotuneUpdate (control_input.height.target - control_input.height.current,
+                                 yawError (control_input.yaw), &duty);
+         control_input.main_enable = phase != AUTOTUNE_MAIN;
+         control_input.tail_enable = phase != AUTOTUNE_TAIL;
+         control_input.duty = duty;
+         break;
      }
+
+     // Hand the inputs to the control interrupt
+     publishControlInput ();
 }
 
 //*****************************************************************************
@@ -227,16 +537,16 @@ dutyResponseMain()
     float proportional;
 
     // Current height error
-    error = height_data.target - height_data.current;
+    error = input->height.target - input->height.current;
 
     // Proportional response
-    proportional = proportional_gain_main * error;
+    proportional = input->gains.proportional_main * error;
 
     // Integral response for current time step
-    step_integral = integral_gain_main * error;
+    step_integral = input->gains.integral_main * error;
 
     // Total response duty cycle
-    duty_cycle = proportional + (integral_main + step_integral) + offset_duty_main;
+    duty_cycle = proportional + (integral_main + step_integral) + input->offset_duty_main;
 
     // Limit duty cycle values and prevent integral windup
     if (duty_cycle > MAX_DUTY_MAIN) {
@@ -251,35 +561,50 @@ dutyResponseMain()
 }
 
 //*****************************************************************************
-// Calculate helicopter tail rotor response using PI control
+// Yaw error for the shortest rotation direction
 //*****************************************************************************
-int32_t
-dutyResponseTail()
+static int16_t
+yawError (yaw_data_s yaw)
 {
-    uint32_t duty_cycle;
-    float step_integral;
     int16_t error;
-    int16_t proportional;
     int16_t full_rot = 360;    // Degrees in full rotation
     int16_t half_rot = 180;    // Half rotation
 
     // Current yaw error for shortest rotation direction, accounting for -179 to 180 degree range
-    if (yaw_data.current < 0 && (yaw_data.target > (yaw_data.current + half_rot)))  {
-        error = -1 * (full_rot - (yaw_data.target - yaw_data.current));
-    } else if (yaw_data.current > 0 && (yaw_data.target < (yaw_data.current - half_rot))) {
-        error = (full_rot + (yaw_data.target - yaw_data.current));
+    if (yaw.current < 0 && (yaw.target > (yaw.current + half_rot)))  {
+        error = -1 * (full_rot - (yaw.target - yaw.current));
+    } else if (yaw.current > 0 && (yaw.target < (yaw.current - half_rot))) {
+        error = (full_rot + (yaw.target - yaw.current));
     } else {
-        error = yaw_data.target - yaw_data.current;
+        error = yaw.target - yaw.current;
     }
 
+    return error;
+}
+
+//*****************************************************************************
+// Calculate helicopter tail rotor response using PI control
+//*****************************************************************************
+int32_t
+dutyResponseTail()
+{
+    int32_t duty_cycle;
+    float step_integral;
+    int16_t error;
+    int16_t proportional;
+
+    // Current yaw error for shortest rotation direction
+    error = yawError(input->yaw);
+
     // Proportional response
-    proportional = proportional_gain_tail * error;
+    proportional = input->gains.proportional_tail * error;
 
     // Integral response for current time step
-    step_integral = integral_gain_tail * error;
+    step_integral = input->gains.integral_tail * error;
 
     // Total response duty cycle
-    duty_cycle = proportional + (integral_tail + step_integral) + COUPLING_OFFSET;
+    duty_cycle = proportional + (integral_tail + step_integral)
+                 + (float) coupling_tail / (1 << Q24_SHIFT);
 
     // Limit duty cycle values and prevent integral windup
     if (duty_cycle > MAX_DUTY_TAIL) {
@@ -293,11 +618,174 @@ dutyResponseTail()
     return duty_cycle;
 }
 
+//*****************************************************************************
+// Main rotor PI control in Q8.24 fixed point, matching dutyResponseMain
+//*****************************************************************************
+int32_t
+dutyResponseMainFixed()
+{
+    int32_t duty_cycle;
+    int32_t error;
+    q24_t step_integral;
+    q24_t total;
+
+    // Current height error
+    error = input->height.target - input->height.current;
+
+    // Integral response for current time step
+    step_integral = q24MulInt (input->gains_q.integral_main, error);
+
+    // Total response duty cycle: proportional, integral and hover offset
+    total = q24Add (integral_main_q, step_integral);
+    total = q24Add (q24MulInt (input->gains_q.proportional_main, error), total);
+    total = q24Add (total, q24FromInt (input->offset_duty_main));
+    duty_cycle = q24ToInt (total);
+
+    // Limit duty cycle values and prevent integral windup
+    if (duty_cycle > MAX_DUTY_MAIN) {
+        duty_cycle = MAX_DUTY_MAIN;
+    } else if (duty_cycle < MIN_DUTY_MAIN) {
+        duty_cycle = MIN_DUTY_MAIN;
+    } else {
+        integral_main_q = q24Add (integral_main_q, step_integral);
+    }
+
+    return duty_cycle;
+}
+
+//*****************************************************************************
+// Tail rotor PI control in Q8.24 fixed point, matching dutyResponseTail
+//*****************************************************************************
+int32_t
+dutyResponseTailFixed()
+{
+    int32_t duty_cycle;
+    int32_t error;
+    int32_t proportional;
+    q24_t step_integral;
+    q24_t total;
+
+    // Current yaw error for shortest rotation direction
+    error = yawError(input->yaw);
+
+    // Proportional response, truncated to whole percent as in the float version
+    proportional = q24ToInt (q24MulInt (input->gains_q.proportional_tail, error));
+
+    // Integral response for current time step
+    step_integral = q24MulInt (input->gains_q.integral_tail, error);
+
+    // Total response duty cycle
+    total = q24Add (integral_tail_q, step_integral);
+    total = q24Add (q24FromInt (proportional), total);
+    total = q24Add (total, coupling_tail);
+    duty_cycle = q24ToInt (total);
+
+    // Limit duty cycle values and prevent integral windup
+    if (duty_cycle > MAX_DUTY_TAIL) {
+        duty_cycle = MAX_DUTY_TAIL;
+    } else if (duty_cycle < MIN_DUTY_TAIL) {
+        duty_cycle = MIN_DUTY_TAIL;
+    } else {
+        integral_tail_q = q24Add (integral_tail_q, step_integral);
+    }
+
+    return duty_cycle;
+}
+
+#ifdef PI_LOCKSTEP
+//*****************************************************************************
+// Send the float against fixed point comparison as CSV lines
+//*****************************************************************************
+static void
+lockstepLine (void (*send)(char *line), char *name, lockstep_s *ls)
+{
+    char line[112];
+    uint32_t float_mean = ls->steps ? ls->float_cycles / ls->steps : 0;
+    uint32_t fixed_mean = ls->steps ? ls->fixed_cycles / ls->steps : 0;
+
+    usprintf (line, "%s,%u,%u,%u,%u,%u,%u,%d\r\n", name, ls->steps, ls->mismatches,
+              ls->max_difference, (uint32_t) (ls->max_integral_error * 1000000),
+              float_mean, fixed_mean, (int32_t) (float_mean - fixed_mean));
+    send (line);
+}
+
+void
+responseControlLockstepReport (void (*send)(char *line))
+{
+    send ("controller,steps,mismatches,max_difference,max_integral_error_ppm,float_mean,fixed_mean,saving\r\n");
+    lockstepLine (send, "main", &lockstep_main);
+    lockstepLine (send, "tail", &lockstep_tail);
+}
+#endif
+
+//*****************************************************************************
+// Seed the hover duty from calibration
+//*****************************************************************************
+void
+responseControlWarmStart (uint32_t hover_duty)
+{
+    control_input.offset_duty_main = hover_duty;
+    warm_start = true;
+    publishControlInput ();
+}
+
+//*****************************************************************************
+// Pass the hover duty out of module
+//*****************************************************************************
+uint32_t
+getHoverDuty (void)
+{
+    return control_input.offset_duty_main;
+}
+
+//*****************************************************************************
+// Use new PI gains while flying
+//*****************************************************************************
+void
+responseControlSetGains (const pi_gains_s *set)
+{
+    gains = *set;
+    setGains (&gains);
+    publishControlInput ();
+}
+
+//*****************************************************************************
+// Pass the PI gains used while flying out of module
+//*****************************************************************************
+pi_gains_s
+responseControlGains (void)
+{
+    return gains;
+}
+
+//*****************************************************************************
+// Use a calibrated coupling map
+//*****************************************************************************
+void
+responseControlSetCoupling (const coupling_map_s *map)
+{
+    control_input.coupling = *map;
+    publishControlInput ();
+}
+
+//*****************************************************************************
+// Pass the coupling map out of module
+//*****************************************************************************
+coupling_map_s
+responseControlCoupling (void)
+{
+    return control_input.coupling;
+}
+
 //*****************************************************************************
 // Pass PWM main and tail duties out of module
 //*****************************************************************************
 duty_cycle_s
 getHeliDuty(void)
 {
-    return heli_duty;
+    duty_cycle_s duty;
+
+    seqlockRead (&heli_duty_lock, &duty, &heli_duty, sizeof (duty));
+
+    return duty;
 }
@@ -7,8 +7,16 @@
 // Motion control for helicopter. Takes current helicopter state, position and
 // target position from the main and drives the rotors appropriately.
 //
+// The PI controllers are float by default. Defining PI_FIXED_POINT selects
+// the Q8.24 fixed point versions; defining PI_LOCKSTEP runs both every step
+// and records their divergence and cost for responseControlLockstepReport.
+// Defining GAIN_SCHEDULE takes the gains while flying from the height
+// schedule (gainSchedule.h) rather than the single set. The tail
+// controller adds a feed-forward against the main rotor's torque from a
+// calibrated map (coupling.h).
+//
 // Authors: T.R. Peterson, M.G. Gardyne, M. Comber
-// Last modified: 19/5/2021
+// Last modified: 18/10/2026
 //
 // *******************************************************
 
@@ -16,13 +24,13 @@
 #include <stdbool.h>
 #include "altitude.h"
 #include "yaw.h"
+#include "coupling.h"
 
 //*****************************************************************************
 // Constants
 //*****************************************************************************
 #define MAX_DUTY_MAIN               98   // Maximum helicopter duty cycle
 #define MIN_DUTY_MAIN               28    // Minimum helicopter duty cycle
-#define COUPLING_OFFSET             25   // Helicopter hover duty
 #define MAX_DUTY_TAIL               97   // Minimum helicopter duty cycle
 #define MIN_DUTY_TAIL               2    // Minimum helicopter duty cycle
 #define TIMER_RATE                  2000 // Determines rate of timer interrupt
@@ -35,6 +43,14 @@ typedef struct {
     uint32_t tail;
 } duty_cycle_s;
 
+// PI gains. Integral gains are per control step, at TIMER_RATE.
+typedef struct {
+    float proportional_main;    // Duty (%) per % of height error
+    float integral_main;
+    float proportional_tail;    // Duty (%) per degree of yaw error
+    float integral_tail;
+} pi_gains_s;
+
 //*****************************************************************************
 // Intialise timer for PI control update
 //*****************************************************************************
@@ -53,4 +69,55 @@ updateResponseControl (height_data_s height_data, yaw_data_s yaw_data);
 duty_cycle_s
 getHeliDuty(void);
 
+//*****************************************************************************
+// Warm start: seed the hover duty from calibration, so initialising only
+// verifies it at the normal integral gain instead of winding up to find it
+//*****************************************************************************
+void
+responseControlWarmStart (uint32_t hover_duty);
+
+//*****************************************************************************
+// Pass the hover duty found while initialising out of module
+//*****************************************************************************
+uint32_t
+getHoverDuty (void);
+
+//*****************************************************************************
+// Use new PI gains while flying. All four reach the control interrupt
+// together, from its next step; the integral values carry on, so the
+// duties do not jump. With GAIN_SCHEDULE the schedule is used instead
+// while flying, and these gains only outside it.
+//*****************************************************************************
+void
+responseControlSetGains (const pi_gains_s *gains);
+
+//*****************************************************************************
+// Pass the PI gains used while flying out of module
+//*****************************************************************************
+pi_gains_s
+responseControlGains (void);
+
+//*****************************************************************************
+// Use a calibrated coupling map, from the next control step. The map is
+// still learnt in flight from there.
+//*****************************************************************************
+void
+responseControlSetCoupling (const coupling_map_s *map);
+
+//*****************************************************************************
+// Pass the coupling map out of module
+//*****************************************************************************
+coupling_map_s
+responseControlCoupling (void);
+
+#ifdef PI_LOCKSTEP
+//*****************************************************************************
+// Send the float against fixed point comparison as CSV lines: steps, steps
+// with differing duty, largest duty difference, largest integral difference
+// (millionths of a %) and mean cycles per step for each implementation
+//*****************************************************************************
+void
+responseControlLockstepReport (void (*send)(char *line));
+#endif
+
 #endif /* RESPONSECONTROL_H_ */
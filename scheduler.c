@@ -0,0 +1,169 @@
+//*****************************************************************************
+//
+// scheduler.c
+//
+// Rate monotonic cooperative scheduler. Tasks are kept in priority (period)
+// order; after each task completes the table is scanned again from the top,
+// so a higher rate task never waits for more than one lower rate task.
+// When nothing is due the processor sleeps until the next interrupt, since
+// releases only change on SysTick; the sleep time is accumulated as idle.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "scheduler.h"
+#include "system.h"
+#include "hal.h"
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+static sched_task_s *sched_tasks;
+static uint32_t sched_count;
+static uint64_t idle_cycles;                // Time asleep since the last reset
+static uint32_t stats_start;                // SysTick count at the last reset
+
+//*****************************************************************************
+// Order the table by period and release every task now
+//*****************************************************************************
+void
+schedulerInit (sched_task_s *tasks, uint32_t count)
+{
+    sched_task_s task;
+    uint32_t now = getSysTicks ();
+    uint32_t i;
+    uint32_t j;
+
+    // Stable insertion sort, so equal periods keep their table order
+    for (i = 1; i < count; i++) {
+        task = tasks[i];
+        for (j = i; j > 0 && tasks[j - 1].period > task.period; j--)
+            tasks[j] = tasks[j - 1];
+        tasks[j] = task;
+    }
+
+    for (i = 0; i < count; i++)
+        tasks[i].release = now;
+
+    sched_tasks = tasks;
+    sched_count = count;
+    schedulerReset ();
+}
+
+//*****************************************************************************
+// Run the highest priority due task, returning false if none was due
+//*****************************************************************************
+static bool
+schedulerDispatch (void)
+{
+    sched_task_s *task;
+    uint32_t now = getSysTicks ();
+    uint32_t late;
+    uint32_t start;
+    uint32_t cycles;
+    uint32_t i;
+
+    for (i = 0; i < sched_count; i++) {
+        task = &sched_tasks[i];
+
+        // Wrap safe test for the release time having passed
+        late = now - task->release;
+        if ((int32_t) late < 0)
+            continue;
+
+        // Skip releases that passed while the task was waiting
+        if (late >= task->period) {
+            task->overruns += late / task->period;
+            task->release += (late / task->period) * task->period;
+        }
+        task->release += task->period;
+
+        start = halCycleCount ();
+        task->run ();
+        cycles = halCycleCount () - start;
+
+        task->runs++;
+        task->exec_total += cycles;
+        if (cycles > task->exec_max)
+            task->exec_max = cycles;
+
+        return true;
+    }
+
+    return false;
+}
+
+//*****************************************************************************
+// Run the tasks forever, sleeping when none are due
+//*****************************************************************************
+void
+schedulerRun (void)
+{
+    while (1)
+    {
+        if (!schedulerDispatch ())
+            idle_cycles += halIdle ();
+    }
+}
+
+//*****************************************************************************
+// CPU load from the idle time over the SysTicks since the last reset
+//*****************************************************************************
+uint32_t
+schedulerCPULoad (void)
+{
+    uint64_t elapsed = (uint64_t) (getSysTicks () - stats_start) *
+                       (halClockGet () / SCHED_TICK_HZ);
+
+    if (elapsed == 0 || idle_cycles >= elapsed)
+        return 0;
+
+    return 1000 - idle_cycles * 1000 / elapsed;
+}
+
+//*****************************************************************************
+// Task statistics
+//*****************************************************************************
+void
+schedulerReport (void (*send)(char *line))
+{
+    char line[96];
+    sched_task_s *task;
+    uint32_t load;
+    uint32_t i;
+
+    load = schedulerCPULoad ();
+    usprintf (line, "sched,tick_hz=%u,unit_hz=%u,cpu_load=%u.%u%%\r\n", SCHED_TICK_HZ,
+              halCycleRate (), load / 10, load % 10);
+    send (line);
+    send ("task,period,runs,overruns,exec_mean,exec_max\r\n");
+
+    for (i = 0; i < sched_count; i++) {
+        task = &sched_tasks[i];
+        usprintf (line, "%s,%u,%u,%u,%u,%u\r\n", task->name, task->period, task->runs,
+                  task->overruns, task->runs ? (uint32_t) (task->exec_total / task->runs) : 0,
+                  task->exec_max);
+        send (line);
+    }
+
+    schedulerReset ();
+}
+
+void
+schedulerReset (void)
+{
+    uint32_t i;
+
+    idle_cycles = 0;
+    stats_start = getSysTicks ();
+
+    for (i = 0; i < sched_count; i++) {
+        sched_tasks[i].runs = 0;
+        sched_tasks[i].overruns = 0;
+        sched_tasks[i].exec_max = 0;
+        sched_tasks[i].exec_total = 0;
+    }
+}
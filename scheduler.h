@@ -0,0 +1,73 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+// *******************************************************
+// scheduler.h
+//
+// Rate monotonic cooperative scheduler for the main loop. Each task has a
+// period in SysTicks; the due task with the shortest period runs first and
+// runs to completion. Time comes from the SysTick count, so the schedule is
+// the same on the target and under the host simulator's virtual clock.
+// Each task records its execution time (HAL cycle counter) and overruns,
+// where a release was missed because the task had not started by the time
+// the following one was due. Between tasks the processor sleeps until the
+// next interrupt; the time asleep gives the CPU load.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "system.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define SCHED_TICK_HZ       SAMPLE_RATE_HZ              // SysTick rate
+#define SCHED_MS(ms)        ((ms) * SCHED_TICK_HZ / 1000)   // Period in ticks
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef struct {
+    char *name;
+    void (*run)(void);
+    uint32_t period;            // SysTicks between releases
+    uint32_t release;           // SysTick count of the next release
+    uint32_t runs;
+    uint32_t overruns;          // Releases missed
+    uint32_t exec_max;          // Longest execution (cycle counter units)
+    uint64_t exec_total;
+} sched_task_s;
+
+//*****************************************************************************
+// Order the task table by period (highest priority first) and release
+// every task at the current tick
+//*****************************************************************************
+void
+schedulerInit (sched_task_s *tasks, uint32_t count);
+
+//*****************************************************************************
+// Run the tasks forever
+//*****************************************************************************
+void
+schedulerRun (void);
+
+//*****************************************************************************
+// CPU load since the statistics were last cleared, in tenths of a percent
+//*****************************************************************************
+uint32_t
+schedulerCPULoad (void);
+
+//*****************************************************************************
+// Send the task statistics and CPU load as CSV lines, and clear them
+//*****************************************************************************
+void
+schedulerReport (void (*send)(char *line));
+
+void
+schedulerReset (void);
+
+#endif /* SCHEDULER_H_ */
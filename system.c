@@ -5,27 +5,22 @@
 // Core helicopter system functionality
 //
 // Authors: T.R. Peterson, M.G. Gardyne, M. Comber
-// Last modified: 19/5/2021
+// Last modified: 18/10/2026
 //
 // Code Sourced from:  P.J. Bones  UCECE (acknowledged in function descriptions)
 
 #include <stdint.h>
 #include <stdio.h>
 #include <stdbool.h>
-#include "inc/hw_memmap.h"
-#include "driverlib/adc.h"
-#include "driverlib/gpio.h"
-#include "driverlib/sysctl.h"
-#include "driverlib/systick.h"
-#include "buttons4.h"
-#include "uart.h"
+#include "hal.h"
+#include "altitude.h"
 #include "system.h"
+#include "isrLatency.h"
 
 //*****************************************************************************
 // Globals
 //*****************************************************************************
-static volatile uint8_t slowTick = false;   // Determines rate of UART transmission
-static volatile uint32_t tickCount = 0;
+static volatile uint32_t sysTicks = 0;      // SysTicks since start up
 
 //*****************************************************************************
 // The interrupt handler for the for Clock interrupt.
@@ -33,23 +28,16 @@ static volatile uint32_t tickCount = 0;
 void
 SysTickIntHandler(void)
 {
-    // Set UART transmission rate
-    const uint8_t ticksPerSlow = SYSTICK_RATE_HZ / SLOWTICK_RATE_HZ;
+    LATENCY_ENTER(HAL_INT_SYSTICK);
 
-    // Poll the buttons
-    updateButtons();
+    sysTicks++;
 
+#ifdef ADC_SYSTICK_TRIGGER
     // Read ADC value to buffer
-    ADCProcessorTrigger(ADC0_BASE, 3);
+    halADCTrigger();
+#endif
 
-    // Update slowTick value for UART transmission
-    if (++tickCount >= ticksPerSlow)
-    {
-        tickCount = 0;
-        slowTick = true;
-    } else {
-        slowTick = false;
-    }
+    LATENCY_EXIT(HAL_INT_SYSTICK);
 }
 
 //*****************************************************************************
@@ -59,9 +47,9 @@ void
 SoftResetIntHandler (void)
 {
     // Clean up, clearing the interrupt
-    GPIOIntClear(GPIO_PORTA_BASE, GPIO_PIN_6);
+    halSoftResetIntClear();
 
-    SysCtlReset();
+    halSystemReset();
 }
 
 //*****************************************************************************
@@ -72,19 +60,11 @@ void
 initClock (void)
 {
     // Set the clock rate to 20 MHz
-    SysCtlClockSet (SYSCTL_SYSDIV_10 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN |
-                   SYSCTL_XTAL_16MHZ);
+    halClockInit();
     //
-    // Set up the period for the SysTick timer.  The SysTick timer period is
-    // set as a function of the system clock.
-    SysTickPeriodSet(SysCtlClockGet() / SAMPLE_RATE_HZ);
-    //
-    // Register the interrupt handler
-    SysTickIntRegister(SysTickIntHandler);
-    //
-    // Enable interrupt and device
-    SysTickIntEnable();
-    SysTickEnable();
+    // Set up the SysTick timer.  The SysTick timer period is set as a
+    // function of the system clock.
+    halSysTickInit(halClockGet() / SAMPLE_RATE_HZ, SysTickIntHandler);
 }
 
 //*****************************************************************************
@@ -93,28 +73,15 @@ initClock (void)
 void
 initSoftReset (void)
 {
-    // Enable port peripheral
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
-
-    // Set pin 0 and 1 as input
-    GPIOPinTypeGPIOInput(GPIO_PORTA_BASE, GPIO_PIN_6);
-
-    // Set pad configuration
-    GPIOPadConfigSet (GPIO_PORTA_BASE, GPIO_PIN_6, GPIO_STRENGTH_2MA,
-           GPIO_PIN_TYPE_STD_WPU);
-
-    // Register interrupt
-    GPIOIntRegister(GPIO_PORTA_BASE, SoftResetIntHandler);
-
-    // Enable pin
-    GPIOIntEnable(GPIO_PORTA_BASE, GPIO_PIN_6);
+    // Configure PA6 as a pulled up input and register its interrupt
+    halSoftResetInit(SoftResetIntHandler);
 }
 
 //*************************************************************
-// Pass slowTick to main for UART transmission
+// Pass time since start up out of module, in SysTicks
 //*************************************************************
-uint8_t
-getSlowTick(void)
+uint32_t
+getSysTicks(void)
 {
-   return slowTick;
+    return sysTicks;
 }
@@ -32,9 +32,10 @@ void
 initSoftReset (void);
 
 //*************************************************************
-// Pass slowTick to main for UART transmission
+// Pass time since start up out of module, in SysTicks
+// (SAMPLE_RATE_HZ per second)
 //*************************************************************
-uint8_t
-getSlowTick(void);
+uint32_t
+getSysTicks(void);
 
 #endif /* SYSTEM_H_ */
@@ -0,0 +1,220 @@
+//*****************************************************************************
+//
+// telemetry.c
+//
+// Binary telemetry frame encoding and decoding: little endian packing,
+// CRC-16/CCITT and COBS framing. Has no hardware dependencies so the host
+// decoder (tools/teleDecode.c) builds it unchanged.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "telemetry.h"
+
+//*****************************************************************************
+// Little endian packing
+//*****************************************************************************
+static uint8_t *
+put16 (uint8_t *p, uint16_t value)
+{
+    *p++ = value;
+    *p++ = value >> 8;
+    return p;
+}
+
+static uint8_t *
+put32 (uint8_t *p, uint32_t value)
+{
+    p = put16 (p, value);
+    return put16 (p, value >> 16);
+}
+
+static uint16_t
+get16 (const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t
+get32 (const uint8_t *p)
+{
+    return get16 (p) | ((uint32_t) get16 (p + 2) << 16);
+}
+
+//*****************************************************************************
+// CRC-16/CCITT, bitwise to keep the table out of flash
+//*****************************************************************************
+uint16_t
+telemetryCRC (const uint8_t *data, uint32_t length)
+{
+    uint16_t crc = 0xFFFF;
+    int bit;
+
+    while (length--) {
+        crc ^= (uint16_t) *data++ << 8;
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
+
+//*****************************************************************************
+// Checksum and COBS encode a payload
+//*****************************************************************************
+uint32_t
+telemetryPack (const uint8_t *payload, uint32_t length, uint8_t *out)
+{
+    uint8_t *start = out;
+    uint8_t *code;
+    uint8_t crc[2];
+    uint32_t i;
+
+    put16 (crc, telemetryCRC (payload, length));
+
+    // COBS: each zero is replaced by the distance to the next one. A frame
+    // is shorter than 254 bytes so no extra code bytes are needed.
+    code = out++;
+    *code = 1;
+    for (i = 0; i < length + 2; i++) {
+        uint8_t byte = i < length ? payload[i] : crc[i - length];
+
+        if (byte == 0) {
+            code = out++;
+            *code = 1;
+        } else {
+            *out++ = byte;
+            (*code)++;
+        }
+    }
+    *out++ = 0;
+
+    return out - start;
+}
+
+//*****************************************************************************
+// Undo the COBS encoding of length bytes (without the delimiter) and check
+// the CRC, returning the payload length or -1 if the frame is invalid
+//*****************************************************************************
+int32_t
+telemetryUnpack (const uint8_t *encoded, uint32_t length, uint8_t *payload)
+{
+    uint32_t in = 0;
+    uint32_t out = 0;
+    uint8_t code;
+
+    if (length < 3 || length > TELEMETRY_PACK_MAX + 3)
+        return -1;
+
+    while (in < length) {
+        code = encoded[in++];
+        if (code == 0 || in + code - 1 > length)
+            return -1;
+        while (--code)
+            payload[out++] = encoded[in++];
+        if (in < length)
+            payload[out++] = 0;
+    }
+
+    if (out < 2 || telemetryCRC (payload, out - 2) != get16 (payload + out - 2))
+        return -1;
+
+    return out - 2;
+}
+
+//*****************************************************************************
+// Pack, checksum and COBS encode a frame
+//*****************************************************************************
+uint32_t
+telemetryEncode (const telemetry_frame_s *frame, uint8_t *out)
+{
+    uint8_t raw[TELEMETRY_PAYLOAD_LEN];
+    uint8_t *p = raw;
+
+    p = put16 (p, frame->seq);
+    p = put32 (p, frame->time_ms);
+    p = put16 (p, frame->height.current);
+    p = put16 (p, frame->height.target);
+    p = put16 (p, frame->yaw.current);
+    p = put16 (p, frame->yaw.target);
+    *p++ = frame->duty.main;
+    *p++ = frame->duty.tail;
+    *p = frame->state;
+
+    return telemetryPack (raw, TELEMETRY_PAYLOAD_LEN, out);
+}
+
+//*****************************************************************************
+// Decoder
+//*****************************************************************************
+void
+telemetryDecoderInit (telemetry_decoder_s *decoder)
+{
+    memset (decoder, 0, sizeof (*decoder));
+}
+
+//*****************************************************************************
+// Unpack the bytes received since the last zero, returning true for a
+// valid frame
+//*****************************************************************************
+static bool
+telemetryDecodeFrame (telemetry_decoder_s *decoder, telemetry_frame_s *frame)
+{
+    uint8_t raw[TELEMETRY_RAW_LEN];
+    const uint8_t *p = raw;
+
+    if (decoder->overflow || decoder->length != TELEMETRY_RAW_LEN + 1 ||
+        telemetryUnpack (decoder->buffer, decoder->length, raw) != TELEMETRY_PAYLOAD_LEN)
+        return false;
+
+    frame->seq = get16 (p);
+    frame->time_ms = get32 (p + 2);
+    frame->height.current = get16 (p + 6);
+    frame->height.target = get16 (p + 8);
+    frame->yaw.current = get16 (p + 10);
+    frame->yaw.target = get16 (p + 12);
+    frame->duty.main = p[14];
+    frame->duty.tail = p[15];
+    frame->state = (flight_mode) p[16];
+
+    return true;
+}
+
+bool
+telemetryDecoderPush (telemetry_decoder_s *decoder, uint8_t byte,
+                      telemetry_frame_s *frame)
+{
+    bool valid;
+
+    if (byte != 0) {
+        if (decoder->length < sizeof (decoder->buffer))
+            decoder->buffer[decoder->length++] = byte;
+        else
+            decoder->overflow = true;
+        return false;
+    }
+
+    // Delimiter: decode what came before it, ignoring repeated zeros
+    if (decoder->length == 0 && !decoder->overflow)
+        return false;
+
+    valid = telemetryDecodeFrame (decoder, frame);
+    decoder->length = 0;
+    decoder->overflow = false;
+
+    if (!valid) {
+        decoder->errors++;
+        return false;
+    }
+
+    if (decoder->frames)
+        decoder->lost += (uint16_t) (frame->seq - decoder->next_seq);
+    decoder->next_seq = frame->seq + 1;
+    decoder->frames++;
+
+    return true;
+}
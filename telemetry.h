@@ -0,0 +1,101 @@
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+// *******************************************************
+// telemetry.h
+//
+// Binary telemetry frames. Each frame carries a sequence number, a
+// millisecond timestamp and the height, yaw, duty and state values sent by
+// UARTTransData, followed by a CRC-16/CCITT of those bytes. The frame is
+// COBS encoded and terminated by a zero byte, so a receiver can resync at
+// any zero. The same code encodes on the target and decodes on the host.
+//
+// Frame before encoding (little endian):
+//   seq u16, time_ms u32, height current/target i16, yaw current/target i16,
+//   main duty u8, tail duty u8, state u8, crc u16
+//
+// telemetryPack and telemetryUnpack give the same CRC and COBS framing to
+// other payloads, such as the flight recorder dump (recorder.h).
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+// *******************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "altitude.h"
+#include "yaw.h"
+#include "flight_mode.h"
+#include "responseControl.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define TELEMETRY_PAYLOAD_LEN   17      // Bytes before the CRC
+#define TELEMETRY_RAW_LEN       (TELEMETRY_PAYLOAD_LEN + 2)
+#define TELEMETRY_FRAME_LEN     (TELEMETRY_RAW_LEN + 2)    // COBS code and delimiter
+#define TELEMETRY_PACK_MAX      250     // Largest payload for telemetryPack
+#define TELEMETRY_PACKED_LEN(length)    ((length) + 4)      // Encoded size
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef struct {
+    uint16_t seq;
+    uint32_t time_ms;
+    height_data_s height;
+    yaw_data_s yaw;
+    duty_cycle_s duty;
+    flight_mode state;
+} telemetry_frame_s;
+
+typedef struct {
+    uint8_t buffer[TELEMETRY_RAW_LEN + 1];  // Encoded bytes since the last zero
+    uint32_t length;
+    bool overflow;              // Too many bytes for a frame since the last zero
+    uint16_t next_seq;          // Sequence number expected next
+    uint32_t frames;            // Valid frames decoded
+    uint32_t errors;            // Frames with bad length, encoding or CRC
+    uint32_t lost;              // Frames missing from the sequence
+} telemetry_decoder_s;
+
+//*****************************************************************************
+// CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF)
+//*****************************************************************************
+uint16_t
+telemetryCRC (const uint8_t *data, uint32_t length);
+
+//*****************************************************************************
+// Checksum and COBS encode up to TELEMETRY_PACK_MAX payload bytes into out
+// (TELEMETRY_PACKED_LEN bytes, ending with the zero delimiter), returning
+// the encoded length
+//*****************************************************************************
+uint32_t
+telemetryPack (const uint8_t *payload, uint32_t length, uint8_t *out);
+
+//*****************************************************************************
+// Decode the length bytes before a zero delimiter into payload, returning
+// the payload length, or -1 for bad encoding or CRC
+//*****************************************************************************
+int32_t
+telemetryUnpack (const uint8_t *encoded, uint32_t length, uint8_t *payload);
+
+//*****************************************************************************
+// Encode a frame into out (TELEMETRY_FRAME_LEN bytes), returning its length
+//*****************************************************************************
+uint32_t
+telemetryEncode (const telemetry_frame_s *frame, uint8_t *out);
+
+//*****************************************************************************
+// Receive side: feed bytes one at a time; returns true when a valid frame
+// has been completed and written to frame
+//*****************************************************************************
+void
+telemetryDecoderInit (telemetry_decoder_s *decoder);
+
+bool
+telemetryDecoderPush (telemetry_decoder_s *decoder, uint8_t byte,
+                      telemetry_frame_s *frame);
+
+#endif /* TELEMETRY_H_ */
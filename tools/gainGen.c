@@ -0,0 +1,203 @@
+//*****************************************************************************
+//
+// gainGen.c
+//
+// Generates gainTable.h, the height gain schedule compiled in with
+// -DGAIN_SCHEDULE, from the tuning file gainSchedule.txt. Checks that the
+// heights rise and lie in the height range, and that up and down tables
+// have the same heights, and converts the integral gains from per second
+// to per control step (TIMER_RATE).
+//
+// Build from the project directory:
+//   gcc -DHAL_HOST -I. tools/gainGen.c -o gainGen
+//
+// Usage: gainGen tuning_file header
+//   e.g. gainGen gainSchedule.txt gainTable.h
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#ifdef HAL_HOST
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "responseControl.h"
+#include "gainSchedule.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define GEN_MAX_ROWS    GAIN_TABLE_MAX_LEN
+#define GEN_LINE_LEN    256
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+typedef struct {
+    int height;
+    pi_gains_s gains;           // Integral gains per second until written
+} gen_row_s;
+
+typedef struct {
+    const char *name;
+    gen_row_s rows[GEN_MAX_ROWS];
+    int length;
+} gen_table_s;
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+static gen_table_s tables[GAIN_DIRECTIONS] = {
+    [GAIN_UP] = { .name = "up" },
+    [GAIN_DOWN] = { .name = "down" },
+};
+static gen_table_s both = { .name = "both" };
+
+//*****************************************************************************
+// Add a row to a table, checking its height
+//*****************************************************************************
+static bool
+genAdd (gen_table_s *table, const gen_row_s *row, const char *file, int line)
+{
+    if (table->length == GEN_MAX_ROWS) {
+        fprintf (stderr, "%s:%d: more than %d %s rows\n", file, line, GEN_MAX_ROWS, table->name);
+        return false;
+    }
+    if (row->height < 0 || row->height > 100) {
+        fprintf (stderr, "%s:%d: height %d outside 0 to 100\n", file, line, row->height);
+        return false;
+    }
+    if (table->length && row->height <= table->rows[table->length - 1].height) {
+        fprintf (stderr, "%s:%d: heights must rise\n", file, line);
+        return false;
+    }
+    table->rows[table->length++] = *row;
+    return true;
+}
+
+//*****************************************************************************
+// Write one table's rows
+//*****************************************************************************
+static void
+genWriteRows (FILE *out, const gen_table_s *table)
+{
+    int i;
+
+    fprintf (out, "    {   // %s\n", table->name);
+    for (i = 0; i < table->length; i++)
+    {
+        const pi_gains_s *g = &table->rows[i].gains;
+
+        fprintf (out, "        { .proportional_main = %.6ef, .integral_main = %.6ef,\n"
+                      "          .proportional_tail = %.6ef, .integral_tail = %.6ef },\n",
+                 g->proportional_main, g->integral_main / TIMER_RATE,
+                 g->proportional_tail, g->integral_tail / TIMER_RATE);
+    }
+    fprintf (out, "    },\n");
+}
+
+int
+main (int argc, char *argv[])
+{
+    FILE *in;
+    FILE *out;
+    char text[GEN_LINE_LEN];
+    char direction[16];
+    gen_row_s row;
+    const gen_table_s *write[GAIN_DIRECTIONS];
+    int directions;
+    int line = 0;
+    int i;
+    int d;
+
+    if (argc != 3) {
+        fprintf (stderr, "Usage: %s tuning_file header\n", argv[0]);
+        return 1;
+    }
+    in = fopen (argv[1], "r");
+    if (!in) {
+        perror (argv[1]);
+        return 1;
+    }
+
+    while (fgets (text, sizeof (text), in))
+    {
+        line++;
+        if (strspn (text, " \t\r\n") == strlen (text) || text[strspn (text, " \t")] == '#')
+            continue;
+
+        if (sscanf (text, "%15s %d %f %f %f %f", direction, &row.height,
+                    &row.gains.proportional_main, &row.gains.integral_main,
+                    &row.gains.proportional_tail, &row.gains.integral_tail) != 6) {
+            fprintf (stderr, "%s:%d: expected direction height main_kp main_ki tail_kp tail_ki\n",
+                     argv[1], line);
+            return 1;
+        }
+
+        if (strcmp (direction, "both") == 0) {
+            if (!genAdd (&both, &row, argv[1], line))
+                return 1;
+        } else if (strcmp (direction, "up") == 0) {
+            if (!genAdd (&tables[GAIN_UP], &row, argv[1], line))
+                return 1;
+        } else if (strcmp (direction, "down") == 0) {
+            if (!genAdd (&tables[GAIN_DOWN], &row, argv[1], line))
+                return 1;
+        } else {
+            fprintf (stderr, "%s:%d: direction must be both, up or down\n", argv[1], line);
+            return 1;
+        }
+    }
+    fclose (in);
+
+    // Either one table for both directions, or matching up and down tables
+    if (both.length && !tables[GAIN_UP].length && !tables[GAIN_DOWN].length) {
+        write[0] = &both;
+        directions = 1;
+    } else if (!both.length && tables[GAIN_UP].length &&
+               tables[GAIN_UP].length == tables[GAIN_DOWN].length) {
+        for (i = 0; i < tables[GAIN_UP].length; i++)
+            if (tables[GAIN_UP].rows[i].height != tables[GAIN_DOWN].rows[i].height) {
+                fprintf (stderr, "%s: up and down rows must have the same heights\n", argv[1]);
+                return 1;
+            }
+        write[GAIN_UP] = &tables[GAIN_UP];
+        write[GAIN_DOWN] = &tables[GAIN_DOWN];
+        directions = GAIN_DIRECTIONS;
+    } else {
+        fprintf (stderr, "%s: give both rows, or up and down rows at the same heights\n", argv[1]);
+        return 1;
+    }
+
+    out = fopen (argv[2], "w");
+    if (!out) {
+        perror (argv[2]);
+        return 1;
+    }
+
+    fprintf (out, "#ifndef GAINTABLE_H_\n#define GAINTABLE_H_\n\n");
+    fprintf (out, "// Generated from %s by tools/gainGen.c; edit that file and regenerate.\n"
+                  "// Integral gains are per control step.\n\n", argv[1]);
+    fprintf (out, "#define GAIN_TABLE_LEN          %d\n", write[0]->length);
+    fprintf (out, "#define GAIN_TABLE_DIRECTIONS   %d\n\n", directions);
+    fprintf (out, "static const int16_t gain_table_height[GAIN_TABLE_LEN] = {");
+    for (i = 0; i < write[0]->length; i++)
+        fprintf (out, "%s%d", i ? ", " : " ", write[0]->rows[i].height);
+    fprintf (out, " };\n\n");
+    fprintf (out, "static const pi_gains_s gain_table[GAIN_TABLE_DIRECTIONS][GAIN_TABLE_LEN] = {\n");
+    for (d = 0; d < directions; d++)
+        genWriteRows (out, write[d]);
+    fprintf (out, "};\n\n#endif /* GAINTABLE_H_ */\n");
+
+    if (fclose (out) != 0) {
+        perror (argv[2]);
+        return 1;
+    }
+
+    return 0;
+}
+
+#endif /* HAL_HOST */
@@ -0,0 +1,241 @@
+//*****************************************************************************
+//
+// handoffStress.c
+//
+// Host stress test for the lock free handoff in handoff.h. A simulated
+// control interrupt is run at random points inside every copy the main
+// loop makes (handoff.h's HANDOFF_PREEMPT hook fires between bytes). Each
+// value written is filled entirely from one sequence number, so a torn
+// read shows as fields that disagree.
+//
+// Main loop to interrupt: the main loop publishes numbered inputs through
+// a double buffer, and the interrupt checks every input it reads is whole
+// and never older than the last. Interrupt to main loop: the interrupt
+// publishes numbered duties through a sequence lock, and the main loop
+// checks every read is whole. The same traffic is also copied through
+// plain shared structures, which must show tearing for the run to prove
+// anything.
+//
+// Build from the project directory:
+//   gcc -DHAL_HOST -I. tools/handoffStress.c -o handoffStress
+//
+// Usage: handoffStress [-n iterations] [-s seed] [-p preempt_one_in]
+//
+// Exits non-zero if a handoff read was torn or stale.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#ifdef HAL_HOST
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void stressPreempt (void);
+#define HANDOFF_PREEMPT()   stressPreempt ()
+#include "handoff.h"
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+// Shaped like the control input: mixed field sizes and padding
+typedef struct {
+    int16_t height_current;
+    int16_t height_target;
+    int16_t yaw_current;
+    int16_t yaw_target;
+    bool main_enable;
+    uint32_t duty_main;
+    uint32_t offset;
+    float gain;
+    uint32_t sequence;
+} stress_input_s;
+
+typedef struct {
+    uint32_t main;
+    uint32_t tail;
+} stress_duty_s;
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+static unsigned int seed = 1;
+static uint32_t preempt_one_in = 8;
+static bool in_isr;
+
+// Handoff under test
+static stress_input_s input_slots[2];
+static double_buffer_s input_buffer;
+static stress_duty_s duty_shared;
+static seqlock_s duty_lock;
+
+// Unsynchronised control
+static stress_input_s input_plain;
+static stress_duty_s duty_plain;
+
+// Interrupt state
+static uint32_t duty_sequence;
+static uint32_t last_input;
+
+// Results
+static uint32_t isr_runs;
+static uint32_t torn_inputs;
+static uint32_t stale_inputs;
+static uint32_t torn_duties;
+static uint32_t plain_torn_inputs;
+static uint32_t plain_torn_duties;
+
+//*****************************************************************************
+// Values filled from a sequence number, zeroing any padding
+//*****************************************************************************
+static void
+inputFill (stress_input_s *in, uint32_t n)
+{
+    memset (in, 0, sizeof (*in));
+    in->height_current = n;
+    in->height_target = ~n;
+    in->yaw_current = n * 3;
+    in->yaw_target = n >> 16;
+    in->main_enable = n & 1;
+    in->duty_main = n ^ 0xA5A5A5A5;
+    in->offset = n * 2654435761u;
+    in->gain = (float) (n & 0xFFFF);
+    in->sequence = n;
+}
+
+static bool
+inputWhole (const stress_input_s *in)
+{
+    stress_input_s expect;
+
+    inputFill (&expect, in->sequence);
+    return memcmp (in, &expect, sizeof (expect)) == 0;
+}
+
+static void
+dutyFill (stress_duty_s *duty, uint32_t n)
+{
+    duty->main = n;
+    duty->tail = ~n;
+}
+
+static bool
+dutyWhole (const stress_duty_s *duty)
+{
+    return duty->tail == ~duty->main;
+}
+
+//*****************************************************************************
+// Simulated control interrupt
+//*****************************************************************************
+static void
+stressISR (void)
+{
+    const stress_input_s *in;
+    stress_duty_s duty;
+
+    in_isr = true;
+    isr_runs++;
+
+    in = doubleBufferFront (&input_buffer, input_slots, sizeof (stress_input_s));
+    if (!inputWhole (in))
+        torn_inputs++;
+    else if (in->sequence < last_input)
+        stale_inputs++;
+    else
+        last_input = in->sequence;
+
+    if (!inputWhole (&input_plain))
+        plain_torn_inputs++;
+
+    dutyFill (&duty, ++duty_sequence);
+    seqlockWrite (&duty_lock, &duty_shared, &duty, sizeof (duty));
+    handoffCopy (&duty_plain, &duty, sizeof (duty));
+
+    in_isr = false;
+}
+
+//*****************************************************************************
+// Preemption point: run the interrupt at random, never inside itself
+//*****************************************************************************
+static void
+stressPreempt (void)
+{
+    if (!in_isr && rand_r (&seed) % preempt_one_in == 0)
+        stressISR ();
+}
+
+int
+main (int argc, char *argv[])
+{
+    uint32_t iterations = 1000000;
+    stress_input_s input;
+    stress_duty_s duty;
+    uint32_t n;
+    int opt;
+
+    while ((opt = getopt (argc, argv, "n:s:p:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            iterations = strtoul (optarg, NULL, 0);
+            break;
+        case 's':
+            seed = strtoul (optarg, NULL, 0);
+            break;
+        case 'p':
+            // At every point the sequence lock reader would never finish
+            preempt_one_in = strtoul (optarg, NULL, 0);
+            if (preempt_one_in < 2)
+                preempt_one_in = 2;
+            break;
+        default:
+            fprintf (stderr, "Usage: %s [-n iterations] [-s seed] [-p preempt_one_in]\n",
+                     argv[0]);
+            return 1;
+        }
+    }
+
+    // The interrupt's first read finds a whole input
+    inputFill (&input, 0);
+    memcpy (&input_slots[0], &input, sizeof (input));
+    memcpy (&input_plain, &input, sizeof (input));
+    dutyFill (&duty_shared, 0);
+    dutyFill (&duty_plain, 0);
+
+    for (n = 1; n <= iterations; n++)
+    {
+        // Main loop to interrupt
+        inputFill (&input, n);
+        doubleBufferPublish (&input_buffer, input_slots, &input, sizeof (input));
+        handoffCopy (&input_plain, &input, sizeof (input));
+
+        // Interrupt to main loop
+        seqlockRead (&duty_lock, &duty, &duty_shared, sizeof (duty));
+        if (!dutyWhole (&duty))
+            torn_duties++;
+
+        handoffCopy (&duty, &duty_plain, sizeof (duty));
+        if (!dutyWhole (&duty))
+            plain_torn_duties++;
+    }
+
+    printf ("iterations=%u isr_runs=%u\n", iterations, isr_runs);
+    printf ("torn_inputs=%u stale_inputs=%u torn_duties=%u\n", torn_inputs, stale_inputs,
+            torn_duties);
+    printf ("plain_torn_inputs=%u plain_torn_duties=%u\n", plain_torn_inputs,
+            plain_torn_duties);
+
+    if (plain_torn_inputs == 0 || plain_torn_duties == 0)
+        fprintf (stderr, "Warning: the unsynchronised copies did not tear; raise -n or lower -p\n");
+
+    return torn_inputs || stale_inputs || torn_duties ? 1 : 0;
+}
+
+#endif /* HAL_HOST */
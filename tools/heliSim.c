@@ -0,0 +1,514 @@
+//*****************************************************************************
+//
+// heliSim.c
+//
+// Host simulator for the helicopter firmware. Runs the unmodified flight
+// code as a native process on the virtual clock of hal_host.c, closed
+// around the rig model in plant.c. A standard flight is flown: switch up,
+// initialise, a series of height and yaw setpoint changes made through the
+// buttons, then switch down and land. State changes and tracking figures
+// are reported as key=value lines so runs can be compared by script;
+// yaw_peak_height_steps is the largest yaw error after setpoint changes
+// that only moved the height, and coupling_map the tail coupling map as
+// calibrated by the end of the run. The heights the moving average and
+// the height estimator give the controllers are both compared with the
+// plant's while flying, whichever is in use (-DHEIGHT_ESTIMATOR): *_lag_ms
+// is the delay that best lines each up with the plant and *_noise the RMS
+// error left at that delay; velocity_rms_error is the estimator's.
+// yaw_rate_rms_error is the RMS error of getYawRate at each control
+// update, and yaw_rate_diff_rms_error that of differencing the heading.
+//
+// Build from the project directory, with the course library (buttons4.h)
+// in <lib>:
+//   gcc -DHAL_HOST -I. -I<lib> main.c altitude.c yaw.c responseControl.c
+//       pwmGen.c uart.c display.c system.c flight_mode.c scheduler.c
+//       telemetry.c isrProfile.c isrLatency.c recorder.c calibration.c
+//       autotune.c gainSchedule.c coupling.c heightEstimator.c hal_host.c
+//       plant.c tools/heliSim.c -lm -o heliSim
+//
+// Usage: heliSim [-t seconds] [-s seed] [-y initial_yaw] [-v] [-o file] [-p] [-l] [-r] [-d]
+//                [-j] [-e file] [-a] [-A] [-b seconds]
+//
+// -v copies the firmware UART output to stdout; -o writes it to a file
+// instead, for example to decode a -DTELEMETRY_BINARY build with teleDecode,
+// or the flight recorder dump sent after landing by a -DFLIGHT_RECORDER
+// build with recDecode.
+//
+// Building with -DISR_PROFILE and isrProfile.c adds the -p option, which
+// prints the interrupt cost table for the whole run in host nanoseconds.
+// Building with -DPI_LOCKSTEP adds the -l option, which prints how far the
+// fixed point PI controllers diverged from the float ones and the per-step
+// cost of each (add -DPI_FIXED_POINT to fly on the fixed point output).
+// -r prints the main loop scheduler's task table for the run.
+// -d prints the OLED text as it was at the end of the run.
+// -e keeps the EEPROM in a file, so a second run warm starts from the
+// calibration stored by the first. Pass the first run's final_yaw with -y
+// to start the second run where the first ended.
+// Building with -DAUTOTUNE adds the -a option, which sends the autotune
+// command once hovering at the first setpoint and prints the gains found;
+// the flight plan waits for the experiments and tracking is only measured
+// outside them, so it shows how the new gains fly. -A also stores the
+// gains, so with -e a second run flies on them from the start. -b seconds
+// switches down that far into the experiments instead, to check the rig
+// lands from the middle of one.
+// Building with -DISR_LATENCY adds the -j option, which sends the firmware
+// the histogram command over the UART once landed (see the output with -v)
+// and prints the histograms for the whole run; latency is in host
+// nanoseconds of virtual time from the interrupt being raised.
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#ifdef HAL_HOST
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+#include "buttons4.h"
+#include "flight_mode.h"
+#include "hal_host.h"
+#include "isrProfile.h"
+#include "isrLatency.h"
+#include "plant.h"
+#include "responseControl.h"
+#include "scheduler.h"
+#include "uart.h"
+#include "yaw.h"
+#include "altitude.h"
+#include "heightEstimator.h"
+#include "autotune.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define SIM_SWITCH_UP_TIME  1.0     // Switch raised (s)
+#define SIM_LAND_TIME       22.0    // Switch lowered, after reaching flying (s)
+#define SIM_TUNE_TIME       5.0     // Autotune command sent, after reaching flying (s)
+#define SIM_HEIGHT_STEP     10      // Height change per button push (%)
+#define SIM_YAW_STEP        15      // Yaw change per button push (deg)
+#define SIM_LAG_MAX_MS      200     // Longest height measurement delay looked for
+
+//*****************************************************************************
+// Type definitions
+//*****************************************************************************
+// Height measurement against the plant, at each delay up to SIM_LAG_MAX_MS
+typedef struct {
+    double sq_error[SIM_LAG_MAX_MS + 1];
+    uint32_t samples;
+} sim_lag_s;
+
+typedef struct {
+    double time;        // Seconds after reaching flying
+    int16_t height;     // Height target (%)
+    int16_t yaw;        // Yaw target (deg)
+} sim_setpoint_s;
+
+//*****************************************************************************
+// Global variables
+//*****************************************************************************
+static const sim_setpoint_s flight_plan[] = {
+    { 2.0, 50,   0},
+    { 6.0, 50,  90},
+    {10.0, 20, -45},
+    {14.0, 80, 180},
+    {18.0, 30,   0},
+};
+#define SIM_PLAN_LEN    (sizeof (flight_plan) / sizeof (flight_plan[0]))
+
+static flight_mode sim_state = landed;
+static double flying_time = -1;     // Time flying was reached
+static double landed_time = -1;     // Time landed was reached after flying
+static bool switched_down;
+static double switched_down_time;   // Time the switch was lowered
+static bool request_latency;        // Send the histogram command once landed
+static char autotune_command;       // Autotune command to send, if any
+static bool autotune_sent;
+static double tune_time;            // Time spent autotuning, excluded from the plan
+static double tune_abort_time = -1; // Switch down this far into autotuning
+static uint32_t plan_index;
+static int16_t height_target;
+static int16_t yaw_target;
+
+// Tracking while flying
+static double height_sq_error;
+static double yaw_sq_error;
+static uint32_t error_samples;
+static bool height_only;            // Last setpoint change moved only the height
+static double yaw_peak_height_steps;    // Largest yaw error after such changes
+
+// Height measurements while flying, against the plant's recent heights
+static double height_history[SIM_LAG_MAX_MS + 1];   // Each ms, newest at history_index
+static uint32_t history_index;
+static uint32_t history_steps;
+static double landed_adc;           // Sensor reading at the bottom of the range
+static double boxcar_held;          // Heights at the last control update
+static double estimate_held;
+static float estimate_held_raw;     // Unrounded, to see each update
+static double velocity_sq_error;    // Estimated vertical velocity at each update
+static uint32_t velocity_samples;
+static double yaw_rate_sq_error;    // Yaw rate from the encoder edges at each update
+static double yaw_diff_sq_error;    // Yaw rate by differencing the heading instead
+static int16_t yaw_held;            // Heading and time at the last update
+static double yaw_held_time = -1;
+static sim_lag_s boxcar_lag;
+static sim_lag_s estimate_lag;
+
+int firmwareMain (void);
+
+//*****************************************************************************
+// Wrap an angle to the 180 to -179 degree range
+//*****************************************************************************
+static double
+simWrap (double deg)
+{
+    deg = fmod (deg, 360.0);
+    if (deg > 180.0)
+        deg -= 360.0;
+    else if (deg <= -180.0)
+        deg += 360.0;
+    return deg;
+}
+
+//*****************************************************************************
+// Move the firmware's targets by pushing buttons
+//*****************************************************************************
+static void
+simSetTargets (int16_t height, int16_t yaw)
+{
+    int16_t height_steps = (height - height_target) / SIM_HEIGHT_STEP;
+    int16_t yaw_steps = (int16_t) simWrap (yaw - yaw_target) / SIM_YAW_STEP;
+
+    for (; height_steps > 0; height_steps--)
+        halHostPushButton (UP);
+    for (; height_steps < 0; height_steps++)
+        halHostPushButton (DOWN);
+    for (; yaw_steps > 0; yaw_steps--)
+        halHostPushButton (RIGHT);
+    for (; yaw_steps < 0; yaw_steps++)
+        halHostPushButton (LEFT);
+
+    height_only = height != height_target && yaw == yaw_target;
+    height_target = height;
+    yaw_target = yaw;
+}
+
+//*****************************************************************************
+// Compare a height measurement (%) with the plant's heights over the last
+// SIM_LAG_MAX_MS
+//*****************************************************************************
+static void
+simLagSample (sim_lag_s *lag, double measured)
+{
+    uint32_t delay;
+
+    for (delay = 0; delay <= SIM_LAG_MAX_MS; delay++)
+        lag->sq_error[delay] += pow (measured - height_history[(history_index + SIM_LAG_MAX_MS + 1 - delay)
+                                                              % (SIM_LAG_MAX_MS + 1)], 2);
+    lag->samples++;
+}
+
+//*****************************************************************************
+// Report the delay that best lines a measurement up with the plant, and
+// the RMS error left at that delay as its noise
+//*****************************************************************************
+static void
+simLagReport (const char *name, const sim_lag_s *lag)
+{
+    uint32_t best = 0;
+    uint32_t delay;
+
+    if (!lag->samples)
+        return;
+
+    for (delay = 1; delay <= SIM_LAG_MAX_MS; delay++)
+        if (lag->sq_error[delay] < lag->sq_error[best])
+            best = delay;
+
+    printf ("%s_lag_ms=%u %s_noise=%.3f\n", name, best, name,
+            sqrt (lag->sq_error[best] / lag->samples));
+}
+
+//*****************************************************************************
+// Simulation step: the plant, then the pilot
+//*****************************************************************************
+static void
+simStep (double dt)
+{
+    static const char *state_names[] = {"landed", "initialising", "flying", "landing",
+                                        "autotuning"};
+    const plant_state_s *plant;
+    double now;
+    double flight;
+
+    plantStep (dt);
+
+    now = halHostSeconds ();
+    plant = plantState ();
+
+    if (getState () != sim_state) {
+        sim_state = getState ();
+        printf ("state=%s time=%.3f\n", state_names[sim_state], now);
+        if (sim_state == flying && flying_time < 0)
+            flying_time = now;
+        if (sim_state == landed && switched_down && landed_time < 0) {
+            landed_time = now;
+            if (request_latency)
+                halHostUARTReceive (LATENCY_CMD_REPORT);
+        }
+    }
+
+    if (now >= SIM_SWITCH_UP_TIME && !switched_down)
+        halHostSetSwitch (true);
+
+    if (flying_time < 0 || switched_down)
+        return;
+
+    if (sim_state == autotuning) {
+        // The plan waits for the experiments, unless landing from them
+        tune_time += dt;
+        if (tune_abort_time >= 0 && tune_time >= tune_abort_time) {
+            switched_down = true;
+            switched_down_time = now;
+            halHostSetSwitch (false);
+        }
+        return;
+    }
+
+    flight = now - flying_time - tune_time;
+    if (autotune_command && !autotune_sent && flight >= SIM_TUNE_TIME) {
+        halHostUARTReceive (autotune_command);
+        autotune_sent = true;
+    }
+
+    if (flight >= SIM_LAND_TIME) {
+        switched_down = true;
+        switched_down_time = now;
+        halHostSetSwitch (false);
+        return;
+    }
+
+    if (plan_index < SIM_PLAN_LEN && flight >= flight_plan[plan_index].time) {
+        simSetTargets (flight_plan[plan_index].height, flight_plan[plan_index].yaw);
+        plan_index++;
+    }
+
+    height_sq_error += pow (height_target - 100.0 * plant->height, 2);
+    yaw_sq_error += pow (simWrap (yaw_target - plantYawWrapped ()), 2);
+    error_samples++;
+
+    if (height_only && fabs (simWrap (yaw_target - plantYawWrapped ())) > yaw_peak_height_steps)
+        yaw_peak_height_steps = fabs (simWrap (yaw_target - plantYawWrapped ()));
+
+    // Each ms, the heights the controllers would be given by the moving
+    // average and the estimator, as taken at the last control update, once
+    // there is a full history to compare
+    if (++history_steps < PLANT_STEP_RATE_HZ / 1000)
+        return;
+    history_steps = 0;
+    history_index = (history_index + 1) % (SIM_LAG_MAX_MS + 1);
+    height_history[history_index] = 100.0 * plant->height;
+
+    if (heightEstimate ().height != estimate_held_raw) {
+        estimate_held_raw = heightEstimate ().height;
+        estimate_held = heightEstimatePercent ();
+        boxcar_held = calculate_percent_height (getHeight (), landed_adc + 0.5);
+        velocity_sq_error += pow (heightEstimate ().velocity - 100.0 * plant->height_rate, 2);
+        velocity_samples++;
+
+        yaw_rate_sq_error += pow (getYawRate () - plant->yaw_rate, 2);
+        if (yaw_held_time >= 0)
+            yaw_diff_sq_error += pow (simWrap (getYawCurrent () - yaw_held) / (now - yaw_held_time)
+                                      - plant->yaw_rate, 2);
+        yaw_held = getYawCurrent ();
+        yaw_held_time = now;
+    }
+    if (flight < SIM_LAG_MAX_MS / 1000.0)
+        return;
+
+    simLagSample (&boxcar_lag, boxcar_held);
+    simLagSample (&estimate_lag, estimate_held);
+}
+
+static FILE *uart_file;
+
+static void
+simUARTPrint (char c)
+{
+    putchar (c);
+}
+
+static void
+simUARTWrite (char c)
+{
+    fputc (c, uart_file);
+}
+
+static void
+simPrintLine (char *line)
+{
+    fputs (line, stdout);
+}
+
+int
+main (int argc, char *argv[])
+{
+    plant_params_s params;
+    double seconds = 60;
+    int opt;
+    int reason;
+    bool report_profile = false;
+    bool report_lockstep = false;
+    bool report_sched = false;
+    bool dump_display = false;
+    bool report_latency = false;
+    coupling_map_s coupling;
+    int i;
+
+    plantDefaultParams (&params);
+
+    while ((opt = getopt (argc, argv, "t:s:y:vo:plrdje:aAb:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            seconds = atof (optarg);
+            break;
+        case 's':
+            params.seed = strtoul (optarg, NULL, 0);
+            break;
+        case 'y':
+            params.initial_yaw = atof (optarg);
+            break;
+        case 'v':
+            halHostSetUARTSink (simUARTPrint);
+            break;
+        case 'o':
+            uart_file = fopen (optarg, "wb");
+            if (!uart_file) {
+                perror (optarg);
+                return 1;
+            }
+            halHostSetUARTSink (simUARTWrite);
+            break;
+        case 'p':
+            report_profile = true;
+            break;
+        case 'l':
+            report_lockstep = true;
+            break;
+        case 'r':
+            report_sched = true;
+            break;
+        case 'd':
+            dump_display = true;
+            break;
+        case 'j':
+            report_latency = true;
+            request_latency = true;
+            break;
+        case 'e':
+            halHostEEPROMFile (optarg);
+            break;
+        case 'a':
+            autotune_command = AUTOTUNE_CMD_START;
+            break;
+        case 'A':
+            autotune_command = AUTOTUNE_CMD_STORE;
+            break;
+        case 'b':
+            tune_abort_time = atof (optarg);
+            break;
+        default:
+            fprintf (stderr, "Usage: %s [-t seconds] [-s seed] [-y initial_yaw] [-v] [-o file] [-p] [-l] [-r] [-d] [-j] [-e file] [-a] [-A] [-b seconds]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    plantInit (&params);
+    landed_adc = params.landed_volts / PLANT_ADC_VOLTS * PLANT_ADC_BITS;
+    halHostSetStep (simStep, PLANT_STEP_RATE_HZ);
+
+    reason = halHostRun (firmwareMain, seconds);
+
+    printf ("end=%s time=%.3f\n", reason == HOST_RUN_RESET ? "reset" : "timeout", halHostSeconds ());
+    printf ("time_to_flying=%.3f\n", flying_time < 0 ? -1 : flying_time - SIM_SWITCH_UP_TIME);
+    printf ("time_to_landed=%.3f\n",
+            landed_time < 0 ? -1 : landed_time - switched_down_time);
+    if (error_samples) {
+        printf ("height_rms_error=%.3f\n", sqrt (height_sq_error / error_samples));
+        printf ("yaw_rms_error=%.3f\n", sqrt (yaw_sq_error / error_samples));
+        printf ("yaw_peak_height_steps=%.1f\n", yaw_peak_height_steps);
+        simLagReport ("height_boxcar", &boxcar_lag);
+        simLagReport ("height_estimate", &estimate_lag);
+        printf ("velocity_rms_error=%.3f\n", sqrt (velocity_sq_error / velocity_samples));
+        printf ("yaw_rate_rms_error=%.2f yaw_rate_diff_rms_error=%.2f\n",
+                sqrt (yaw_rate_sq_error / velocity_samples),
+                sqrt (yaw_diff_sq_error / (velocity_samples - 1)));
+    }
+    printf ("main_duty=%.1f tail_duty=%.1f\n", halHostPWMMainDuty (), halHostPWMTailDuty ());
+    printf ("final_yaw=%.1f\n", plantState ()->yaw);
+    coupling = responseControlCoupling ();
+    printf ("coupling_map=");
+    for (i = 0; i < COUPLING_MAP_LEN; i++)
+        printf ("%s%.2f", i ? "," : "", (double) coupling.tail[i] / (1 << Q24_SHIFT));
+    printf ("\n");
+    printf ("yaw_errors=%u\n", getYawErrors ());
+    printf ("uart_queued=%u uart_dropped=%u uart_peak=%u\n", UARTTxStats ().queued,
+            UARTTxStats ().dropped, UARTTxStats ().peak);
+
+#ifdef ISR_PROFILE
+    if (report_profile)
+        isrProfileReport (simPrintLine);
+#else
+    if (report_profile)
+        fprintf (stderr, "Built without ISR_PROFILE\n");
+#endif
+
+#ifdef AUTOTUNE
+    if (autotune_command) {
+        pi_gains_s gains = responseControlGains ();
+
+        printf ("autotune=%s time=%.3f\n",
+                autotunePhase () == AUTOTUNE_DONE ? "done" : "failed", tune_time);
+        printf ("gains main_kp=%.3f main_ki_per_s=%.3f tail_kp=%.3f tail_ki_per_s=%.4f\n",
+                gains.proportional_main, gains.integral_main * TIMER_RATE,
+                gains.proportional_tail, gains.integral_tail * TIMER_RATE);
+    }
+#else
+    if (autotune_command)
+        fprintf (stderr, "Built without AUTOTUNE\n");
+#endif
+
+#ifdef ISR_LATENCY
+    if (report_latency)
+        isrLatencyReport (simPrintLine);
+#else
+    if (report_latency)
+        fprintf (stderr, "Built without ISR_LATENCY\n");
+#endif
+
+    if (uart_file)
+        fclose (uart_file);
+
+    if (report_sched)
+        schedulerReport (simPrintLine);
+
+    if (dump_display)
+        halHostDisplayDump (stdout);
+
+#ifdef PI_LOCKSTEP
+    if (report_lockstep)
+        responseControlLockstepReport (simPrintLine);
+#else
+    if (report_lockstep)
+        fprintf (stderr, "Built without PI_LOCKSTEP\n");
+#endif
+
+    return 0;
+}
+
+#endif /* HAL_HOST */
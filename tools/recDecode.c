@@ -0,0 +1,150 @@
+//*****************************************************************************
+//
+// recDecode.c
+//
+// Host decoder for the flight data recorder dump (recorder.h). Reads the
+// raw UART bytes from a file, or stdin, and prints one CSV line per
+// recorded control step. Time is in milliseconds from the trigger step, or
+// from the first step when the capture was frozen on request. A file may
+// hold several captures; each is numbered. Other traffic on the link, such
+// as text telemetry, is skipped.
+//
+// Build from the project directory:
+//   gcc -DHAL_HOST -I. telemetry.c recorder.c tools/recDecode.c -o recDecode
+//
+// Usage: recDecode [file]
+//   e.g. heliSim -o uart.bin (built with -DFLIGHT_RECORDER), then
+//        recDecode uart.bin > steps.csv
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#ifdef HAL_HOST
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "telemetry.h"
+#include "recorder.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define DECODE_MAX_ENCODED  (TELEMETRY_PACK_MAX + 3)
+
+static const char *state_names[] = {
+    "landed",
+    "initialising",
+    "flying",
+    "landing",
+    "autotuning",
+};
+
+int
+main (int argc, char *argv[])
+{
+    FILE *in = stdin;
+    uint8_t encoded[DECODE_MAX_ENCODED];
+    uint8_t payload[DECODE_MAX_ENCODED];
+    uint32_t length = 0;
+    bool overflow = false;
+    recorder_header_s header;
+    recorder_step_s steps[RECORDER_FRAME_STEPS];
+    uint16_t index;
+    uint32_t count;
+    uint32_t step = 0;
+    uint32_t expected = 0;          // Data frame expected next
+    uint32_t captures = 0;
+    uint32_t frames = 0;
+    uint32_t lost = 0;
+    int32_t unpacked;
+    uint32_t i;
+    double origin;
+    int c;
+
+    if (argc > 2) {
+        fprintf (stderr, "Usage: %s [file]\n", argv[0]);
+        return 1;
+    }
+    if (argc == 2) {
+        in = fopen (argv[1], "rb");
+        if (!in) {
+            perror (argv[1]);
+            return 1;
+        }
+    }
+
+    printf ("capture,step,time_ms,height,height_target,yaw,yaw_target,main_duty,tail_duty,"
+            "integral_main,integral_tail,state,main_sat,tail_sat,trigger\n");
+
+    while ((c = fgetc (in)) != EOF)
+    {
+        if (c != 0) {
+            if (length < sizeof (encoded))
+                encoded[length++] = c;
+            else
+                overflow = true;
+            continue;
+        }
+
+        // Delimiter: anything that does not unpack is other traffic
+        unpacked = overflow ? -1 : telemetryUnpack (encoded, length, payload);
+        length = 0;
+        overflow = false;
+        if (unpacked < 0)
+            continue;
+
+        switch (recorderDecode (payload, unpacked, &header, &index, steps, &count))
+        {
+        case 'H':
+            if (captures && expected < header.frames)
+                lost += header.frames - expected;
+            captures++;
+            fprintf (stderr, "capture=%u steps=%u rate_hz=%u trigger=%d reason=0x%02x\n",
+                     captures, header.steps, header.rate_hz,
+                     header.trigger == RECORDER_NO_TRIGGER ? -1 : header.trigger,
+                     header.reason);
+            step = 0;
+            expected = 0;
+            break;
+        case 'D':
+            // Only frames that belong to the current capture, in order; a
+            // frame of other traffic can pass the CRC and look like one
+            if (!captures || index < expected || index >= header.frames)
+                break;
+            frames++;
+            lost += index - expected;
+            expected = index + 1;
+
+            step = index * RECORDER_FRAME_STEPS;
+            origin = header.trigger == RECORDER_NO_TRIGGER ? 0 : header.trigger;
+            for (i = 0; i < count; i++, step++)
+            {
+                printf ("%u,%u,%.1f,%d,%d,%d,%d,%u,%u,%.3f,%.3f,%s,%u,%u,%u\n",
+                        captures, step, (step - origin) * 1000.0 / header.rate_hz,
+                        steps[i].height_current, steps[i].height_target,
+                        steps[i].yaw_current, steps[i].yaw_target,
+                        steps[i].duty_main, steps[i].duty_tail,
+                        steps[i].integral_main / 256.0, steps[i].integral_tail / 256.0,
+                        state_names[steps[i].flags & RECORDER_FLAG_MODE],
+                        !!(steps[i].flags & RECORDER_FLAG_MAIN_SAT),
+                        !!(steps[i].flags & RECORDER_FLAG_TAIL_SAT),
+                        !!(steps[i].flags & RECORDER_FLAG_TRIGGER));
+            }
+            break;
+        }
+    }
+
+    if (captures && expected < header.frames)
+        lost += header.frames - expected;
+
+    fprintf (stderr, "captures=%u frames=%u lost=%u\n", captures, frames, lost);
+
+    if (in != stdin)
+        fclose (in);
+
+    return 0;
+}
+
+#endif /* HAL_HOST */
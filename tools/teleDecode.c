@@ -0,0 +1,79 @@
+//*****************************************************************************
+//
+// teleDecode.c
+//
+// Host decoder for the binary telemetry stream (telemetry.h). Reads the raw
+// UART bytes from a file, or stdin, and prints one CSV line per valid frame.
+// Frame, error and lost frame counts are printed to stderr at the end.
+// Bytes that are not telemetry (such as the ISR_PROFILE report) count as
+// errors and are otherwise skipped.
+//
+// Build from the project directory:
+//   gcc -DHAL_HOST -I. telemetry.c tools/teleDecode.c -o teleDecode
+//
+// Usage: teleDecode [file]
+//   e.g. stty -F /dev/ttyACM0 115200 raw && teleDecode /dev/ttyACM0
+// at the firmware's BAUD_RATE, 115200 by default with -DTELEMETRY_BINARY
+//
+// Authors: T.R. Peterson, M.G. Gardyne, M. Comber
+// Last modified: 18/10/2026
+//
+
+#ifdef HAL_HOST
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "telemetry.h"
+
+static const char *state_names[] = {
+    "landed",
+    "initialising",
+    "flying",
+    "landing",
+    "autotuning",
+};
+
+int
+main (int argc, char *argv[])
+{
+    FILE *in = stdin;
+    telemetry_decoder_s decoder;
+    telemetry_frame_s frame;
+    int c;
+
+    if (argc > 2) {
+        fprintf (stderr, "Usage: %s [file]\n", argv[0]);
+        return 1;
+    }
+    if (argc == 2) {
+        in = fopen (argv[1], "rb");
+        if (!in) {
+            perror (argv[1]);
+            return 1;
+        }
+    }
+
+    telemetryDecoderInit (&decoder);
+
+    printf ("time_ms,seq,height,height_target,yaw,yaw_target,main_duty,tail_duty,state\n");
+    while ((c = fgetc (in)) != EOF)
+    {
+        if (telemetryDecoderPush (&decoder, c, &frame))
+            printf ("%u,%u,%d,%d,%d,%d,%u,%u,%s\n", frame.time_ms, frame.seq,
+                    frame.height.current, frame.height.target,
+                    frame.yaw.current, frame.yaw.target,
+                    frame.duty.main, frame.duty.tail,
+                    frame.state <= autotuning ? state_names[frame.state] : "unknown");
+    }
+
+    fprintf (stderr, "frames=%u errors=%u lost=%u\n", decoder.frames, decoder.errors,
+             decoder.lost);
+
+    if (in != stdin)
+        fclose (in);
+
+    return 0;
+}
+
+#endif /* HAL_HOST */
@@ -6,100 +6,223 @@
 // Transmits the state, height and yaw (current and target)
 // and the duty cycle values.
 //
+// The ring buffer has a single writer (UARTSend, in the main loop) and a
+// single reader (UARTTxIntHandler). UARTSend masks the TX interrupt while it
+// queues, so the overwrite policy can also move the read index.
+//
 // Author:  P.J. Bones  UCECE
 // Modified by: T.R. Peterson, M.G. Gardyne, M. Comber
-// Last modified:   19/5/2021
+// Last modified:   18/10/2026
 //
 
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
-#include "inc/hw_memmap.h"
-#include "driverlib/gpio.h"
-#include "driverlib/uart.h"
-#include "driverlib/sysctl.h"
-#include "driverlib/pin_map.h"
-#include "utils/ustdlib.h"
 #include "uart.h"
 #include "altitude.h"
 #include "yaw.h"
+#include "system.h"
+#include "telemetry.h"
+#include "hal.h"
 
 char statusStr[MAX_STR_LEN + 1];
 
+static char tx_buffer[UART_TX_BUF_SIZE];
+static volatile uint32_t tx_head;       // Next character to write
+static volatile uint32_t tx_tail;       // Next character to transmit
+static uart_tx_stats_s tx_stats;
+
+//**********************************************************************
+// Move queued characters into the Tx FIFO until it is full
+//**********************************************************************
+static void
+UARTTxDrain (void)
+{
+    while (tx_tail != tx_head &&
+           halUARTCharPutNonBlocking (tx_buffer[tx_tail & (UART_TX_BUF_SIZE - 1)]))
+        tx_tail++;
+}
+
+//**********************************************************************
+// The handler for the UART transmit interrupt, refilling the Tx FIFO
+//**********************************************************************
+void
+UARTTxIntHandler (void)
+{
+    halUARTTxIntClear();
+    UARTTxDrain();
+}
+
 //**********************************************************************
 // Initialise UART
 //**********************************************************************
 void
 initUSB_UART (void)
 {
-    //
-    // Enable GPIO port A which is used for UART0 pins.
-    //
-    SysCtlPeripheralEnable(UART_USB_PERIPH_UART);
-    SysCtlPeripheralEnable(UART_USB_PERIPH_GPIO);
-    //
-    // Select the alternate (UART) function for these pins.
-    //
-    GPIOPinTypeUART(UART_USB_GPIO_BASE, UART_USB_GPIO_PINS);
-    GPIOPinConfigure (GPIO_PA0_U0RX);
-    GPIOPinConfigure (GPIO_PA1_U0TX);
-
-    UARTConfigSetExpClk(UART_USB_BASE, SysCtlClockGet(), BAUD_RATE,
-            UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
-            UART_CONFIG_PAR_NONE);
-    UARTFIFOEnable(UART_USB_BASE);
-    UARTEnable(UART_USB_BASE);
+    // UART0 on PA0 and PA1, 8 data bits, one stop bit, no parity
+    halUARTInit(BAUD_RATE);
+
+    tx_head = 0;
+    tx_tail = 0;
+    UARTTxStatsReset();
+
+    halUARTTxIntInit(UARTTxIntHandler);
+    halUARTTxIntEnable(true);
 }
 
 
 //**********************************************************************
-// Transmit a string via UART0
+// Queue a string for transmission via UART0
 //**********************************************************************
 void
 UARTSend (char *pucBuffer)
 {
-    // Loop while there are more characters to send.
-    while(*pucBuffer)
-    {
-        // Write the next character to the UART Tx FIFO.
-        UARTCharPut(UART_USB_BASE, *pucBuffer);
-        pucBuffer++;
+    UARTSendBytes ((const uint8_t *) pucBuffer, strlen(pucBuffer));
+}
+
+//**********************************************************************
+// Queue a string for transmission via UART0, waiting for room
+//**********************************************************************
+void
+UARTSendWait (char *pucBuffer)
+{
+    uint32_t length = strlen(pucBuffer);
+    uint32_t part;
+
+    while (length) {
+        part = length < UART_TX_BUF_SIZE ? length : UART_TX_BUF_SIZE;
+
+        // The TX interrupt makes room while the processor sleeps
+        while (UARTTxSpace() < part)
+            halIdle();
+
+        UARTSendBytes ((const uint8_t *) pucBuffer, part);
+        pucBuffer += part;
+        length -= part;
     }
 }
 
 //**********************************************************************
-// Update string to be send via UART
+// Queue length bytes for transmission via UART0
 //**********************************************************************
 void
-UARTTransData (height_data_s height_data, yaw_data_s yaw_data, duty_cycle_s heli_duty, flight_mode current_state, uint8_t slowTick)
+UARTSendBytes (const uint8_t *data, uint32_t length)
 {
-    char flight_status[10];
+    uint32_t used;
 
-    if (slowTick)
-    {
-        slowTick = false; // Reset slowtick
-
-        // Assign current state to string for display
-        switch (current_state)
-        {
-        case landed:
-            strcpy(flight_status, "Landed");
-            break;
-        case initialising:
-            strcpy(flight_status, "Initialising");
-            break;
-        case flying:
-            strcpy(flight_status, "Take off");
-            break;
-        case landing:
-            strcpy(flight_status, "Landing");
+    halUARTTxIntEnable(false);
+
+    used = tx_head - tx_tail;
+    if (used + length > UART_TX_BUF_SIZE) {
+#if UART_TX_POLICY == UART_TX_OVERWRITE
+        // Keep the newest characters, discarding from the oldest
+        if (length > UART_TX_BUF_SIZE) {
+            tx_stats.dropped += length - UART_TX_BUF_SIZE;
+            data += length - UART_TX_BUF_SIZE;
+            length = UART_TX_BUF_SIZE;
         }
+        tx_stats.dropped += used + length - UART_TX_BUF_SIZE;
+        tx_tail += used + length - UART_TX_BUF_SIZE;
+#else
+        // Drop the whole string rather than send part of it
+        tx_stats.dropped += length;
+        length = 0;
+#endif
+    }
+
+    tx_stats.queued += length;
+    while (length--)
+        tx_buffer[tx_head++ & (UART_TX_BUF_SIZE - 1)] = *data++;
 
-        // Form and send a status message to the console
-        usprintf (statusStr, "----------------\r\nAlt: %2d [%2d]\r\nYaw: %2d [%2d]\r\nMain %2d Tail %2d\r\nMode: %s\r\n",
-                      height_data.current, height_data.target, yaw_data.current, yaw_data.target, heli_duty.main, heli_duty.tail, flight_status); // * usprintf
-        UARTSend (statusStr);
+    used = tx_head - tx_tail;
+    if (used > tx_stats.peak)
+        tx_stats.peak = used;
+
+    // Start transmission if the FIFO has room, the interrupt does the rest
+    UARTTxDrain();
+    halUARTTxIntEnable(true);
+}
+
+//**********************************************************************
+// Characters that can be queued without dropping any
+//**********************************************************************
+uint32_t
+UARTTxSpace (void)
+{
+    return UART_TX_BUF_SIZE - (tx_head - tx_tail);
+}
+
+//**********************************************************************
+// Transmit counters since initialisation or the last reset
+//**********************************************************************
+uart_tx_stats_s
+UARTTxStats (void)
+{
+    return tx_stats;
+}
+
+void
+UARTTxStatsReset (void)
+{
+    tx_stats.queued = 0;
+    tx_stats.dropped = 0;
+    tx_stats.peak = 0;
+}
+
+//**********************************************************************
+// Next character received from the host, or -1 if there is none
+//**********************************************************************
+int32_t
+UARTReceive (void)
+{
+    return halUARTCharGetNonBlocking();
+}
+
+//**********************************************************************
+// Update string to be send via UART
+//**********************************************************************
+void
+UARTTransData (height_data_s height_data, yaw_data_s yaw_data, duty_cycle_s heli_duty, flight_mode current_state)
+{
+#ifdef TELEMETRY_BINARY
+    static uint16_t seq = 0;
+    telemetry_frame_s frame;
+    uint8_t encoded[TELEMETRY_FRAME_LEN];
+
+    // Frames are small enough to send every TELEMETRY_PERIOD_MS
+    frame.seq = seq++;
+    frame.time_ms = getSysTicks() / (SAMPLE_RATE_HZ / 1000);
+    frame.height = height_data;
+    frame.yaw = yaw_data;
+    frame.duty = heli_duty;
+    frame.state = current_state;
+    UARTSendBytes (encoded, telemetryEncode (&frame, encoded));
+#else
+    char flight_status[16];
+
+    // Assign current state to string for display
+    switch (current_state)
+    {
+    case landed:
+        strcpy(flight_status, "Landed");
+        break;
+    case initialising:
+        strcpy(flight_status, "Initialising");
+        break;
+    case flying:
+        strcpy(flight_status, "Take off");
+        break;
+    case landing:
+        strcpy(flight_status, "Landing");
+        break;
+    case autotuning:
+        strcpy(flight_status, "Autotune");
     }
 
+    // Form and send a status message to the console
+    usnprintf (statusStr, sizeof (statusStr), "----------------\r\nAlt: %2d [%2d]\r\nYaw: %2d [%2d]\r\nMain %2d Tail %2d\r\nMode: %s\r\n",
+                  height_data.current, height_data.target, yaw_data.current, yaw_data.target, heli_duty.main, heli_duty.tail, flight_status); // * usprintf
+    UARTSend (statusStr);
+#endif
 }
 
@@ -8,9 +8,19 @@
 // Transmits the state, height and yaw (current and target)
 // and the duty cycle values.
 //
+// Strings are queued in a transmit ring buffer drained by the UART TX
+// interrupt, so UARTSend does not wait for the link. When a string does
+// not fit, UART_TX_POLICY either drops it or overwrites the oldest queued
+// characters. UARTSendWait instead waits for room, for reports sent on
+// the ground that are too long to fit the buffer at once.
+//
+// Defining TELEMETRY_BINARY replaces the text status message with a
+// telemetry.h frame on every call, for decoding with tools/teleDecode,
+// and raises the default BAUD_RATE to carry the frames.
+//
 // Author:  P.J. Bones  UCECE
 // Modified by: T.R. Peterson, M.G. Gardyne, M. Comber
-// Last modified:   19/5/2021
+// Last modified:   18/10/2026
 //
 // *******************************************************
 
@@ -24,11 +34,22 @@
 //********************************************************
 // Constants
 //********************************************************
-#define SYSTICK_RATE_HZ 100
-#define SLOWTICK_RATE_HZ 40
 #define MAX_STR_LEN 100
 //---USB Serial comms: UART0, Rx:PA0 , Tx:PA1
-#define BAUD_RATE 9600
+#ifndef BAUD_RATE
+#ifdef TELEMETRY_BINARY
+#define BAUD_RATE 115200                // Binary frames every TELEMETRY_PERIOD_MS
+#else
+#define BAUD_RATE 9600                  // Up to 921600
+#endif
+#endif
+#define UART_CHAR_BITS          10      // Start, 8 data and stop bits
+#define UART_TX_DROP            0       // Full buffer: drop the new string
+#define UART_TX_OVERWRITE       1       // Full buffer: discard the oldest characters
+#ifndef UART_TX_POLICY
+#define UART_TX_POLICY          UART_TX_DROP
+#endif
+#define UART_TX_BUF_SIZE        512     // Transmit ring buffer, a power of 2
 #define UART_USB_BASE           UART0_BASE
 #define UART_USB_PERIPH_UART    SYSCTL_PERIPH_UART0
 #define UART_USB_PERIPH_GPIO    SYSCTL_PERIPH_GPIOA
@@ -37,6 +58,15 @@
 #define UART_USB_GPIO_PIN_TX    GPIO_PIN_1
 #define UART_USB_GPIO_PINS      UART_USB_GPIO_PIN_RX | UART_USB_GPIO_PIN_TX
 
+//********************************************************
+// Type definitions
+//********************************************************
+typedef struct {
+    uint32_t queued;        // Characters accepted by UARTSend
+    uint32_t dropped;       // Characters dropped or overwritten
+    uint32_t peak;          // Highest ring buffer occupancy
+} uart_tx_stats_s;
+
 //**********************************************************************
 // Initialise UART
 //**********************************************************************
@@ -44,17 +74,55 @@ void
 initUSB_UART (void);
 
 //**********************************************************************
-// Transmit a string via UART0
+// Queue a string for transmission via UART0
 //**********************************************************************
 void
 UARTSend (char *pucBuffer);
 
 //**********************************************************************
-// Update string to be send via UART
+// Queue a string for transmission via UART0, sleeping until there is room
+// for it rather than dropping it. Only for use once the rotors are off,
+// as the main loop, and so the controllers' inputs, stop while it waits.
+//**********************************************************************
+void
+UARTSendWait (char *pucBuffer);
+
+//**********************************************************************
+// Queue length bytes for transmission via UART0
+//**********************************************************************
+void
+UARTSendBytes (const uint8_t *data, uint32_t length);
+
+//**********************************************************************
+// Free space in the transmit ring buffer, for callers pacing a long
+// binary transfer
+//**********************************************************************
+uint32_t
+UARTTxSpace (void);
+
+//**********************************************************************
+// Transmit counters since initialisation or the last reset
+//**********************************************************************
+uart_tx_stats_s
+UARTTxStats (void);
+
+void
+UARTTxStatsReset (void);
+
+//**********************************************************************
+// Next character received from the host, or -1 if there is none. The
+// receive FIFO holds 16 characters, so poll it at least that often.
+//**********************************************************************
+int32_t
+UARTReceive (void);
+
+//**********************************************************************
+// Send the status message, or telemetry frame, once per call. The main
+// loop's scheduler sets the rate (TELEMETRY_PERIOD_MS).
 //**********************************************************************
 void
 UARTTransData (height_data_s height_data, yaw_data_s yaw_data, duty_cycle_s heli_duty,
-               flight_mode current_state, uint8_t slowTick);
+               flight_mode current_state);
 
 
 #endif /* UART_H_ */
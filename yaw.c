@@ -4,60 +4,133 @@
 //
 // Helicopter yaw functionality. Reads and updates yaw via interrupts to GPIO
 // pins reading from a quadrature encoder disk. Yaw range is 180 to -179.
+// With YAW_QEI the encoder interface keeps the count and only the reference
+// pin interrupts.
+//
+// The GPIO interrupt decodes each edge with a transition table and keeps an
+// unwrapped count; wrapping and conversion to degrees happen when the yaw
+// is read. Transitions that change both phases at once cannot be decoded
+// and are counted as encoder errors. Each decoded edge is timestamped and
+// handed to updateYawRate through a sequence lock, with the time of the
+// quadrature cycle it completes.
 //
 // Authors: T.R. Peterson, M.G. Gardyne, M. Comber
-// Last modified: 19/5/2021
+// Last modified: 18/10/2026
 //
 
 #include <stdint.h>
 #include <stdbool.h>
-#include "inc/hw_memmap.h"
-#include "driverlib/gpio.h"
-#include "driverlib/sysctl.h"
-#include "driverlib/pwm.h"
+#include <stdlib.h>
 #include "yaw.h"
 #include "responseControl.h"
 #include "pwmGen.h"
+#include "isrProfile.h"
+#include "isrLatency.h"
+#include "handoff.h"
+#include "hal.h"
 
 //*****************************************************************************
 // Global variables
 //*****************************************************************************
-static bool a_cur;                          // Current A-phase pin value
-static bool b_cur;                          // Current B-phase pin value
 static bool ref_found;                      // Reference yaw found flag
 static volatile bool ref_enabled = false;   // Enable reference yaw pin interrupt
+static bool approach;                       // Heading seeded, moving to the approach point
+static int16_t yaw_rate;                    // Degrees per second clockwise
+
+#ifndef YAW_QEI
+#define QUAD_ILLEGAL    2                   // Transition table entry for a missed edge
+
+static uint8_t ab_cur;                      // Current A:B phase pin values
+static volatile int32_t yaw_count;          // Heading from quadrature code disc, unwrapped
+static volatile uint32_t yaw_errors;        // Illegal transitions seen
+
+// Latest encoder edge, for the yaw rate
+typedef struct {
+    uint32_t edges;             // Edges since power up, either way
+    int32_t count;              // Edges since power up, unwrapped and never reset
+    uint32_t time;              // Timestamp of the latest edge
+    uint32_t cycle;             // Time over the last YAW_RATE_CYCLE edges, or
+                                // 0 unless they were all the same way
+    int8_t direction;           // Their direction, 1 clockwise
+} yaw_edge_s;
+
+static yaw_edge_s yaw_edge;                 // Written by the interrupt
+static seqlock_s yaw_edge_lock;
+static uint32_t edge_times[YAW_RATE_CYCLE]; // Recent edge times, for the cycle
+static uint8_t edge_index;
+static uint8_t edge_run;                    // Edges in a row the same way
+static yaw_edge_s rate_edge;                // Edge at the last rate update
+static int32_t rate_counted;                // Edges counted at the last rate update
+static bool rate_stopped = true;            // Timed out, until the next edge
+static volatile bool edge_restart;          // Start the next cycle afresh
 
-static yaw_data_s yaw_data;                 // Yaw current and target values
-static int16_t yaw;                         // Helicopter heading from quadrature code disc
+// Count change indexed by previous A:B and next A:B, clockwise 00, 01, 11, 10
+static const int8_t quad_table[16] = {
+//  next: 00            01            10            11
+           0,            1,           -1, QUAD_ILLEGAL,    // previous 00
+          -1,            0, QUAD_ILLEGAL,            1,    // previous 01
+           1, QUAD_ILLEGAL,            0,           -1,    // previous 10
+QUAD_ILLEGAL,           -1,            1,            0,    // previous 11
+};
 
 //*****************************************************************************
 // Function prototypes
 //*****************************************************************************
-void calculateYaw(bool a_next, bool b_next);
+void calculateYaw(uint8_t ab_next, uint32_t time);
+#endif
+
+//*****************************************************************************
+// Wrap a disc count to the 180 to -179 degree range, -223 to 224
+//*****************************************************************************
+static int32_t
+wrapCount (int32_t count)
+{
+    count %= YAW_TOOTH_COUNT;
+
+    if (count > YAW_TOOTH_COUNT / 2)
+        count -= YAW_TOOTH_COUNT;
+    else if (count <= -YAW_TOOTH_COUNT / 2)
+        count += YAW_TOOTH_COUNT;
+
+    return count;
+}
+
+//*****************************************************************************
+// Convert a disc count to degrees, rounded
+//*****************************************************************************
+static int16_t
+countToDegrees (int32_t count)
+{
+    return (2 * count * YAW_FULL_ROT + 1) / (2 * YAW_TOOTH_COUNT);
+}
 
+#ifndef YAW_QEI
 //*************************************************************
 // GPIO Pin Interrupt
 //*************************************************************
 void
 GPIOPinIntHandler (void)
 {
+    LATENCY_ENTER(HAL_INT_YAW_QUAD);
+    PROFILE_START();
+
     // Clean up, clearing the interrupt
-    GPIOIntClear(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    halYawQuadIntClear();
 
     bool a_next;
     bool b_next;
+    uint32_t time = halYawEdgeTime();
 
     // Read next A-phase and B-phase values
-    a_next = GPIOPinRead(GPIO_PORTB_BASE, GPIO_PIN_0);
-    b_next = GPIOPinRead(GPIO_PORTB_BASE, GPIO_PIN_1);
+    halYawPinsRead(&a_next, &b_next);
 
-    // Update yaw in degrees
-    calculateYaw(a_next, b_next);
+    // Update yaw count
+    calculateYaw(a_next << 1 | b_next, time);
 
-    // Update next phase values to current
-    a_cur = a_next;
-    b_cur = b_next;
+    PROFILE_STOP(PROFILE_GPIO_PIN_INT);
+    LATENCY_EXIT(HAL_INT_YAW_QUAD);
 }
+#endif
 
 //*************************************************************
 // GPIO reference yaw pin interrupt
@@ -66,12 +139,15 @@ void
 GPIORefPinIntHandler (void)
 {
     // Clean up, clearing the interrupt
-    GPIOIntClear(GPIO_PORTC_BASE, GPIO_PIN_4);
+    halYawRefIntClear();
 
     // Set ref_found to true and reset yaw values if interrupt enabled
     if (ref_enabled) {
-        yaw = 0;
-        yaw_data.current = 0;
+#ifdef YAW_QEI
+        halQEIPositionSet(0);
+#else
+        yaw_count = 0;
+#endif
         ref_found = true;
     }
 
@@ -86,25 +162,21 @@ GPIORefPinIntHandler (void)
 void
 initGPIOPins (void)
 {
-    // Enable port peripheral
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOC);
-
-    // Set pin 0,1 and 4 as input
-    GPIOPinTypeGPIOInput(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
-    GPIOPinTypeGPIOInput(GPIO_PORTC_BASE, GPIO_PIN_4);
-
-    // Set what pin interrupt conditions
-    GPIOIntTypeSet(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1, GPIO_BOTH_EDGES);
-    GPIOIntTypeSet(GPIO_PORTC_BASE, GPIO_PIN_4, GPIO_RISING_EDGE);
+#ifdef YAW_QEI
+    // Interrupt on the rising edge of PC4 only; QEI0 counts the encoder
+    halYawPinsInit(0, GPIORefPinIntHandler);
+    halQEIInit(YAW_TOOTH_COUNT, halClockGet() / YAW_QEI_VEL_RATE_HZ);
+#else
+    bool a;
+    bool b;
 
-    // Register interrupt
-    GPIOIntRegister(GPIO_PORTB_BASE, GPIOPinIntHandler);
-    GPIOIntRegister(GPIO_PORTC_BASE, GPIORefPinIntHandler);
+    // Interrupt on both edges of PB0 and PB1, and the rising edge of PC4
+    halYawPinsInit(GPIOPinIntHandler, GPIORefPinIntHandler);
 
-    // Enable pins
-    GPIOIntEnable(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1 );
-    GPIOIntEnable(GPIO_PORTC_BASE, GPIO_PIN_4 );
+    // Start decoding from the current phase values
+    halYawPinsRead(&a, &b);
+    ab_cur = a << 1 | b;
+#endif
 }
 
 //*************************************************************
@@ -113,50 +185,68 @@ initGPIOPins (void)
 void
 initYaw (void)
 {
-    // As a precaution, make sure that the peripherals used are reset
-    SysCtlPeripheralReset (PWM_TAIL_PERIPH_GPIO); // Used for PWM output
-    SysCtlPeripheralReset (PWM_TAIL_PERIPH_PWM);  // Tail Rotor PWM
-
     initGPIOPins ();
     initialisePWMTail ();
     initResponseTimer ();
 
     // Initialisation is complete, so turn on the output.
-    PWMOutputState(PWM_TAIL_BASE, PWM_TAIL_OUTBIT, true);
+    halPWMTailEnable(true);
 }
 
+#ifndef YAW_QEI
+//*****************************************************************************
+// Record an edge for the yaw rate, in the interrupt
+//*****************************************************************************
+static void
+recordEdge (int8_t step, uint32_t time)
+{
+    yaw_edge_s edge = yaw_edge;
+
+    // Edges in a row the same way, up to a full cycle. The times held
+    // from before the rate last timed out are too old to use.
+    if (step != edge.direction || edge_restart)
+        edge_run = 0;
+    edge_restart = false;
+    if (edge_run < YAW_RATE_CYCLE)
+        edge_run++;
+
+    // The oldest time held is the edge a full cycle back
+    edge.cycle = edge_run == YAW_RATE_CYCLE ? time - edge_times[edge_index] : 0;
+    edge_times[edge_index] = time;
+    edge_index = (edge_index + 1) % YAW_RATE_CYCLE;
+
+    edge.edges++;
+    edge.count += step;
+    edge.time = time;
+    edge.direction = step;
+
+    seqlockWrite (&yaw_edge_lock, &yaw_edge, &edge, sizeof (edge));
+}
 
 //*****************************************************************************
-// Update helicopter yaw in degrees
+// Update helicopter yaw count from the next A:B phase values, and the time
+// of the edge
 //*****************************************************************************
 void
-calculateYaw(bool a_next, bool b_next)
+calculateYaw(uint8_t ab_next, uint32_t time)
 {
-    bool cw;
-    int16_t full_rot = 360;    // Degrees in full rotation
-    int16_t tooth_count = 448; // Total count in quadrature code disc
-
-    // Find rotation direction using current and next phase values
-    cw = (!a_cur & !b_cur & !a_next & b_next) | (!a_cur & b_cur & a_next & b_next)
-            | (a_cur & b_cur & a_next & !b_next) | (a_cur & !b_cur & !a_next & !b_next);
+    int8_t step;
+    PROFILE_START();
 
-    // Update yaw based on rotation direction
-    if (cw) {
-        yaw++;
-    } else {
-        yaw--;
-    }
+    // Look up the count change for this transition
+    step = quad_table[ab_cur << 2 | ab_next];
+    ab_cur = ab_next;
 
-    // Limit yaw values for 180 to -179 degree range
-    if (yaw >= tooth_count/2 && cw) {
-        yaw = -1 * tooth_count/2 + 1;
-    } else if (yaw <= -1 * tooth_count/2 && !cw) {
-        yaw = tooth_count/2;
+    if (step == QUAD_ILLEGAL) {
+        yaw_errors++;
+    } else if (step) {
+        yaw_count += step;
+        recordEdge (step, time);
     }
 
-    // Convert yaw value to degrees with rounded value
-    yaw_data.current = (2 * yaw * full_rot + 1)/(2 * tooth_count);
+    PROFILE_STOP(PROFILE_CALCULATE_YAW);
 }
+#endif
 
 //*****************************************************************************
 // Sweep helicopter to find reference yaw
@@ -164,19 +254,70 @@ calculateYaw(bool a_next, bool b_next)
 bool
 findReference(void)
 {
+    int16_t error;
+
+    // After a warm start, first reach the approach point under PI control,
+    // so the sweep that follows only has a few degrees to go
+    if (approach) {
+        error = getYawCurrent() - YAW_APPROACH_DEG;
+        if (error > YAW_APPROACH_TOLERANCE || error < -YAW_APPROACH_TOLERANCE)
+            return false;
+        approach = false;
+    }
+
     // Enable reference yaw pin interrupt
     ref_enabled = true;
 
     return ref_found;
 }
 
+//*****************************************************************************
+// Take the yaw from calibration, as where the helicopter was left
+//*****************************************************************************
+void
+yawWarmStart(int32_t count)
+{
+#ifdef YAW_QEI
+    halQEIPositionSet((wrapCount(count) + YAW_TOOTH_COUNT) % YAW_TOOTH_COUNT);
+#else
+    yaw_count = count;
+#endif
+    approach = true;
+}
+
+//*****************************************************************************
+// Pass whether the seeded heading is still moving to the approach point
+//*****************************************************************************
+bool
+yawApproaching(void)
+{
+    return approach;
+}
+
+//*****************************************************************************
+// Pass the disc count from the reference out of module
+//*****************************************************************************
+int32_t
+getYawCount(void)
+{
+#ifdef YAW_QEI
+    return wrapCount(halQEIPosition());
+#else
+    return wrapCount(yaw_count);
+#endif
+}
+
 //*****************************************************************************
 // Pass current yaw out of module
 //*****************************************************************************
 int16_t
 getYawCurrent(void)
 {
-    return yaw_data.current;
+#ifdef YAW_QEI
+    return countToDegrees(wrapCount(halQEIPosition()));
+#else
+    return countToDegrees(wrapCount(yaw_count));
+#endif
 }
 
 //*****************************************************************************
@@ -187,3 +328,91 @@ refFound(void)
 {
     return ref_found;
 }
+
+//*****************************************************************************
+// Pass count of illegal encoder transitions out of module
+//*****************************************************************************
+uint32_t
+getYawErrors(void)
+{
+#ifdef YAW_QEI
+    // Phase errors are not counted in QEI mode
+    return 0;
+#else
+    return yaw_errors;
+#endif
+}
+
+#ifndef YAW_QEI
+//*****************************************************************************
+// Yaw rate in counts per second from the timestamped edges
+//*****************************************************************************
+static int32_t
+edgeRate (void)
+{
+    yaw_edge_s edge;
+    int32_t counted;
+    uint32_t since;
+    uint32_t period;
+    uint32_t clock = halClockGet();
+    int32_t rate = 0;
+
+    seqlockRead (&yaw_edge_lock, &edge, &yaw_edge, sizeof (edge));
+    counted = edge.count - rate_edge.count;
+    since = halYawTime() - edge.time;
+
+    // The time since the last edge wraps, so once it has timed out the
+    // rate stays at zero until there is a new edge
+    if (edge.edges != rate_edge.edges)
+        rate_stopped = false;
+
+    if (rate_stopped) {
+        rate = 0;
+    } else if (since >= clock / 1000 * YAW_RATE_TIMEOUT_MS) {
+        // Stopped, or too slow to measure
+        rate_stopped = true;
+        edge_restart = true;
+        rate = 0;
+    } else if (abs (counted) >= YAW_RATE_COUNT_MIN && abs (rate_counted) >= YAW_RATE_COUNT_MIN) {
+        // High speed: the edges since the last update, timed from the
+        // last edge before it to the latest. That edge is only known to
+        // be close to the last update if it counted enough edges too.
+        rate = (int64_t) counted * clock / (edge.time - rate_edge.time);
+    } else if (edge.cycle) {
+        // Low speed: the last full cycle, or slower if the next edge is
+        // later than the cycle says it should be
+        period = edge.cycle;
+        if (since * YAW_RATE_CYCLE > period)
+            period = since * YAW_RATE_CYCLE;
+        rate = edge.direction * (int32_t) ((uint64_t) YAW_RATE_CYCLE * clock / period);
+    }
+
+    rate_edge = edge;
+    rate_counted = counted;
+
+    return rate;
+}
+#endif
+
+//*****************************************************************************
+// Work out the yaw rate
+//*****************************************************************************
+void
+updateYawRate(void)
+{
+#ifdef YAW_QEI
+    // From the QEI velocity capture
+    yaw_rate = countToDegrees(halQEIVelocity() * YAW_QEI_VEL_RATE_HZ);
+#else
+    yaw_rate = countToDegrees(edgeRate());
+#endif
+}
+
+//*****************************************************************************
+// Pass yaw rate out of module
+//*****************************************************************************
+int16_t
+getYawRate(void)
+{
+    return yaw_rate;
+}
@@ -7,20 +7,47 @@
 // Helicopter yaw functionality. Reads and updates yaw via interrupts to GPIO
 // pins reading from a quadrature encoder disk. Yaw range is 180 to -179.
 //
+// Defining YAW_QEI counts the encoder with the quadrature encoder interface
+// instead, so encoder edges no longer interrupt the processor. This needs
+// the encoder phases wired to PD6 and PD7 (see halQEIInit).
+//
+// The yaw rate is worked out by updateYawRate at the control rate. From
+// the GPIO interrupts each edge is timestamped: at low speed the rate is
+// one full quadrature cycle (YAW_RATE_CYCLE edges) over its period, and at
+// high speed, from the second update in a row with YAW_RATE_COUNT_MIN
+// edges, the edges counted since the last update over the time from the
+// last edge before it to the latest. Either way it is limited by the time since
+// the last edge, falling to zero after YAW_RATE_TIMEOUT_MS without one.
+// With YAW_QEI it is the QEI velocity capture.
+//
 // Authors: T.R. Peterson, M.G. Gardyne, M. Comber
-// Last modified: 19/5/2021
+// Last modified: 18/10/2026
 //
 // *******************************************************
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
 
+//*************************************************************
+// Constants
+//*************************************************************
+#define YAW_TOOTH_COUNT     448  // Total count in quadrature code disc
+#define YAW_FULL_ROT        360  // Degrees in full rotation
+#define YAW_QEI_VEL_RATE_HZ 50   // QEI velocity capture rate, one per control update (YAW_QEI)
+#define YAW_RATE_CYCLE      4    // Edges in a quadrature cycle, timed at low speed
+#define YAW_RATE_COUNT_MIN  8    // Edges since the last update to count instead
+#define YAW_RATE_TIMEOUT_MS 500  // No edge for this long is a yaw rate of zero
+#define YAW_APPROACH_DEG    -12  // Warm start: heading the reference sweep starts from
+#define YAW_APPROACH_TOLERANCE 9 // Warm start: approach heading error accepted (deg)
+
 //*************************************************************
 // Type definitions
 //*************************************************************
 typedef struct {
     int16_t current;
     int16_t target;
+    int16_t rate;               // Degrees per second clockwise (getYawRate)
 } yaw_data_s;
 
 //*************************************************************
@@ -35,16 +62,58 @@ initYaw (void);
 bool
 findReference(void);
 
+//*****************************************************************************
+// Warm start: take count, from the reference, as the disc position. The
+// reference is then only verified: findReference waits for the helicopter
+// to be held near YAW_APPROACH_DEG, just short of the reference in the
+// sweep direction, before the sweep starts, so the edge is met after a few
+// degrees if the helicopter has not been moved, and after the usual search
+// if it has.
+//*****************************************************************************
+void
+yawWarmStart(int32_t count);
+
+//*****************************************************************************
+// True while a warm started helicopter is moving to the approach point
+//*****************************************************************************
+bool
+yawApproaching(void);
+
 //*****************************************************************************
 // Pass current yaw out of module
 //*****************************************************************************
 int16_t
 getYawCurrent(void);
 
+//*****************************************************************************
+// Pass the disc count from the reference, -223 to 224, out of module
+//*****************************************************************************
+int32_t
+getYawCount(void);
+
 //*****************************************************************************
 // Pass reference found out of module
 //*****************************************************************************
 bool
 refFound(void);
 
+//*****************************************************************************
+// Pass count of illegal encoder transitions (both phases changing between
+// interrupts) out of module
+//*****************************************************************************
+uint32_t
+getYawErrors(void);
+
+//*****************************************************************************
+// Work out the yaw rate, at the control rate
+//*****************************************************************************
+void
+updateYawRate(void);
+
+//*****************************************************************************
+// Pass yaw rate out of module, degrees per second clockwise
+//*****************************************************************************
+int16_t
+getYawRate(void);
+
 #endif /* YAW_H_ */